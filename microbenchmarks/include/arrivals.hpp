@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+enum ArrivalProcess { ARRIVALS_CONSTANT, ARRIVALS_POISSON };
+
+// intended start times of the operations of one open-loop thread. Operations are issued at
+// these times no matter how long the previous ones took, so latencies measured from them
+// include the time an operation had to wait behind slow predecessors (coordinated omission).
+class ArrivalSchedule {
+    public:
+        ArrivalSchedule() = delete;
+        // rate in operations per second
+        explicit ArrivalSchedule(double rate, ArrivalProcess process, uint32_t seed);
+        // waits until the intended start of the next operation and returns it. Returns right
+        // away if the thread is behind schedule.
+        uint64_t wait_next();
+    private:
+        double interval_ns;
+        ArrivalProcess process;
+        std::mt19937 generator;
+        std::exponential_distribution<> interval_dis;
+        // the first operation starts when it is asked for
+        bool started;
+        double next_ns;
+};
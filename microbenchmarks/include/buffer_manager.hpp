@@ -3,10 +3,16 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "buffer_pool.hpp"
+#include "histogram.hpp"
 #include "iowrapper.hpp"
+#include "placement.hpp"
+#include "pmem_tier.hpp"
 
 enum BMStatus {
     BM_READ_FAILURE,
@@ -17,19 +23,109 @@ enum BMStatus {
 
 bool ok(const BMStatus status);
 
+struct BMCompletion {
+    uint64_t tag;
+    BMStatus status;
+};
+
+// a mount directory and how its buffer file is accessed, config.directory is set from directory
+struct Mount {
+    std::string directory;
+    std::function<IOWrapper*(struct IOWrapperConfig&)> create_io_wrapper;
+    struct IOWrapperConfig config;
+};
+
 class BufferManager {
     public:
         BufferManager() = delete;
-        explicit BufferManager(std::vector<std::string>& dirs, const char* file_suffix, const std::size_t page_size, const std::size_t pages_per_buffer_file, const bool use_fadvise, const bool pmem_use_cacheline_granularity,  const bool mmap_use_map_sync, std::function<IOWrapper*(struct IOWrapperConfig&)> create_io_wrapper, const bool fadv_random, const bool fadv_sequential, const bool madv_random, const bool madv_sequential, const bool mmap_populate);
+        explicit BufferManager(std::vector<std::string>& dirs, const char* file_suffix, const std::size_t page_size, const std::size_t pages_per_buffer_file, const bool use_fadvise, const bool pmem_use_cacheline_granularity,  const bool mmap_use_map_sync, std::function<IOWrapper*(struct IOWrapperConfig&)> create_io_wrapper, const bool fadv_random, const bool fadv_sequential, const bool madv_random, const bool madv_sequential, const bool mmap_populate, const bool uring_sqpoll, const unsigned int queue_depth, const struct DurabilityConfig& durability, const char *read_kernel, const char *write_kernel);
+        // every mount with its own engine and options
+        explicit BufferManager(const std::vector<struct Mount>& mounts, const std::size_t page_size, const std::size_t pages_per_buffer_file);
         ~BufferManager();
         BMStatus pagein(void *dest, const uint64_t page_id);
         BMStatus pageout(void *src, const uint64_t page_id);
+        // (page_id, buffer) pairs, split by mount and issued with one call per mount. The batches
+        // are timed as a whole, not per page.
+        BMStatus pagein_batch(const std::vector<std::pair<uint64_t, void*>>& pages);
+        BMStatus pageout_batch(const std::vector<std::pair<uint64_t, void*>>& pages);
+        BMStatus submit_pagein(void *dest, const uint64_t page_id, const uint64_t tag);
+        BMStatus submit_pageout(void *src, const uint64_t page_id, const uint64_t tag);
+        std::size_t poll(std::vector<BMCompletion>& completions);
+        std::size_t wait(std::vector<BMCompletion>& completions, const std::size_t min_completions = 1);
+        void register_buffers(const std::vector<struct iovec>& memory);
+
+        // DRAM buffer pool, only usable after a pool has been attached. The same pool can be
+        // attached to the buffer managers of several threads, statistics are kept per buffer manager.
+        void attach_pool(std::shared_ptr<BufferPool> pool);
+        // writes back the dirty frames and lets go of the pool, and of the tier if one is attached
+        void detach_pool();
+        bool has_pool() const;
+        const BufferPool& get_pool() const;
+        const BufferPoolStats& get_pool_stats() const;
+        void *pin(const uint64_t page_id);
+        void unpin(const uint64_t page_id, const bool dirty);
+        // copies a page to dest, reading it straight from the tier if it is there but not in the pool
+        // and the tier reads in place, through a pinned frame otherwise
+        BMStatus read_page(const uint64_t page_id, void *dest);
+        BMStatus flush();
+        // PMem tier below the pool, which has to be attached first. Frames are loaded from the tier
+        // if it has the page and evicted frames of hot pages go into it, the buffer files only get
+        // the pages the tier does not keep. Shared like the pool, statistics are kept per buffer manager.
+        void attach_tier(std::shared_ptr<PMemTier> tier);
+        bool has_tier() const;
+        const TierStats& get_tier_stats() const;
+        // latencies of the synchronous pagein/pageout calls, asynchronous requests are not timed
+        void set_latency_tracking(const bool enabled);
+        std::vector<std::pair<std::string, const LatencyHistogram*>> get_latencies() const;
+        // pages are interleaved one by one over the mounts unless a different placement is set
+        void set_placement(std::function<PagePlacement*(std::size_t, uint64_t, const struct PlacementConfig&)> create_placement, const struct PlacementConfig& config);
+        // MiB/s of reading the start of every mount's buffer file sequentially in large chunks,
+        // queue_depth of them at a time. The page cache is bypassed with O_DIRECT, or emptied
+        // beforehand on file systems without it, so the device is measured rather than the engine.
+        std::vector<double> measure_bandwidth(const unsigned int queue_depth);
+        // lets sweeps reuse the open buffer files for further runs
+        void set_page_size(const std::size_t page_size, const std::size_t pages_per_buffer_file);
+        void reset_statistics();
         uint64_t get_total_num_of_pages() const;
         uint32_t get_mem_alignment();
         std::size_t get_page_size() const;
     private:
+        void add_mount(const std::string& dir, const std::function<IOWrapper*(struct IOWrapperConfig&)>& create_io_wrapper, struct IOWrapperConfig config);
         int lookup(IOWrapper **responsible_wrapper, uint64_t *internal_id, const uint64_t page_id);
+        int lookup_index(std::size_t *buffer_id, uint64_t *internal_id, const uint64_t page_id);
+        // fills batches with the requests of pages per buffer
+        int split_batch(const std::vector<std::pair<uint64_t, void*>>& pages);
+        // pins page_id without counting the access for the tier
+        void *fetch(const uint64_t page_id);
+        // fill and empty frames, from and to the tier if there is one
+        BMStatus load(void *dest, const uint64_t page_id);
+        BMStatus evict_page(void *src, const uint64_t page_id, const bool dirty);
+        // copies a page into a slot of the tier, demoting the page that had it. False if no slot was free.
+        bool promote(void *src, const uint64_t page_id, const bool dirty);
+        // writes a dirty page into its slot, false if the page is not in the tier
+        bool write_to_tier(void *src, const uint64_t page_id, BMStatus *status);
+        BMStatus flush_tier();
         std::vector<IOWrapper*> buffers;
+        std::vector<std::string> buffer_files;
         std::size_t page_size;
         std::size_t pages_per_buffer_file;
+        std::function<PagePlacement*(std::size_t, uint64_t, const struct PlacementConfig&)> create_placement;
+        struct PlacementConfig placement_config;
+        std::unique_ptr<PagePlacement> placement;
+        std::vector<IOCompletion> io_completions;
+        std::vector<std::vector<IORequest>> batches;
+        std::vector<std::pair<uint64_t, void*>> flush_batch;
+        std::vector<std::size_t> flush_frames;
+        std::shared_ptr<BufferPool> pool;
+        BufferPoolStats pool_stats;
+        std::shared_ptr<PMemTier> tier;
+        TierStats tier_stats;
+        // demoted pages are written back from here
+        std::unique_ptr<AlignedMemoryBlock> tier_staging;
+        bool track_latency = true;
+        LatencyHistogram pagein_latency;
+        LatencyHistogram pageout_latency;
+        LatencyHistogram pagein_batch_latency;
+        LatencyHistogram pageout_batch_latency;
+        std::size_t collect(std::vector<BMCompletion>& completions);
 };
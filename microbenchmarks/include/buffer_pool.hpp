@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "page_table.hpp"
+#include "util.hpp"
+
+#define INVALID_PAGE_ID UINT64_MAX
+#define INVALID_FRAME_ID SIZE_MAX
+
+// admit and victim are serialized by the buffer pool, access is called concurrently on hits
+// and must not block.
+class EvictionPolicy {
+    public:
+        virtual ~EvictionPolicy() {};
+        // frame_id was (re)filled with page_id
+        virtual void admit(std::size_t frame_id, uint64_t page_id) = 0;
+        // the page in frame_id was hit
+        virtual void access(std::size_t frame_id) = 0;
+        // picks a frame to reuse. try_claim tries to take a frame away from everyone else and has to
+        // succeed for the returned frame, returns INVALID_FRAME_ID if no frame could be claimed.
+        // The frame keeps its page until it is admitted again, installing the new page may still fail.
+        virtual std::size_t victim(const std::function<bool(std::size_t)>& try_claim) = 0;
+};
+
+class ClockEvictionPolicy : public EvictionPolicy {
+    public:
+        ClockEvictionPolicy() = delete;
+        explicit ClockEvictionPolicy(std::size_t num_frames);
+        void admit(std::size_t frame_id, uint64_t page_id) override;
+        void access(std::size_t frame_id) override;
+        std::size_t victim(const std::function<bool(std::size_t)>& try_claim) override;
+    private:
+        std::vector<std::atomic<uint8_t>> referenced;
+        std::size_t hand;
+};
+
+// LRU-K with K = 2, without retaining history of evicted pages.
+// hits are only recorded if the history is not locked by someone else.
+class LRU2EvictionPolicy : public EvictionPolicy {
+    public:
+        LRU2EvictionPolicy() = delete;
+        explicit LRU2EvictionPolicy(std::size_t num_frames);
+        void admit(std::size_t frame_id, uint64_t page_id) override;
+        void access(std::size_t frame_id) override;
+        std::size_t victim(const std::function<bool(std::size_t)>& try_claim) override;
+    private:
+        std::mutex latch;
+        // (second to last access, last access, frame), ordered by backward 2-distance
+        using HistoryKey = std::tuple<uint64_t, uint64_t, std::size_t>;
+        std::set<HistoryKey> history;
+        std::vector<uint64_t> last_access;
+        std::vector<uint64_t> penultimate_access;
+        std::vector<bool> tracked;
+        uint64_t clock;
+};
+
+// full 2Q (Johnson & Shasha) with A1in/A1out sized 25%/50% of the frames.
+// like LRU2, hits are only recorded if the queues are not locked by someone else.
+class TwoQEvictionPolicy : public EvictionPolicy {
+    public:
+        TwoQEvictionPolicy() = delete;
+        explicit TwoQEvictionPolicy(std::size_t num_frames);
+        void admit(std::size_t frame_id, uint64_t page_id) override;
+        void access(std::size_t frame_id) override;
+        std::size_t victim(const std::function<bool(std::size_t)>& try_claim) override;
+    private:
+        enum Queue { NONE, A1IN, AM };
+        std::size_t victim_from(std::list<std::size_t>& queue, const std::function<bool(std::size_t)>& try_claim);
+        void remember(uint64_t page_id);
+        std::list<std::size_t> a1in;
+        std::list<std::size_t> am;
+        std::list<uint64_t> a1out;
+        std::unordered_map<uint64_t, std::list<uint64_t>::iterator> a1out_index;
+        std::vector<Queue> queue_of;
+        std::vector<std::list<std::size_t>::iterator> position;
+        std::vector<uint64_t> page_of;
+        std::size_t kin;
+        std::size_t kout;
+        std::mutex latch;
+};
+
+template<typename Policy>
+EvictionPolicy *create_eviction_policy(std::size_t num_frames) {
+    return new Policy{num_frames};
+}
+
+// state is the pin count, or FRAME_LOCKED while the frame is written back or (re)loaded
+#define FRAME_LOCKED UINT32_MAX
+
+struct Frame {
+    std::atomic<uint64_t> page_id;
+    std::atomic<uint32_t> state;
+    std::atomic<bool> dirty;
+};
+
+struct BufferPoolStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t writebacks;
+};
+
+// DRAM frames plus page table and eviction bookkeeping, shared by any number of threads. The pool
+// does not do any I/O itself, the BufferManager loads and writes back frames.
+// Hits are lock-free: a page table lookup followed by a CAS on the frame state. Misses serialize
+// on the eviction latch only while picking a victim and admitting the new page, I/O happens
+// with just the frame locked.
+class BufferPool {
+    public:
+        BufferPool() = delete;
+        explicit BufferPool(std::size_t num_frames, std::size_t page_size, uint32_t alignment, EvictionPolicy *policy, std::size_t num_mounts);
+        ~BufferPool();
+        // pins page_id if it is resident and returns its frame, INVALID_FRAME_ID otherwise.
+        // waits if the page is being loaded by another thread.
+        std::size_t pin_resident(uint64_t page_id);
+        // returns a locked frame, which still is in the page table under its old page. If it holds
+        // a dirty page, the caller has to write it back before installing a new page. Waits while
+        // every frame is pinned.
+        std::size_t evict();
+        // maps page_id to the locked frame_id. Returns false if another thread got there first, the
+        // caller then has to release the frame and pin the page again.
+        bool install(std::size_t frame_id, uint64_t page_id);
+        // the page has been read into the installed frame, which becomes pinned once
+        void loaded(std::size_t frame_id);
+        // unlocks a frame without changing what it holds
+        void release(std::size_t frame_id);
+        // locks an unpinned frame (for writing it back), false if it is pinned or locked
+        bool try_lock(std::size_t frame_id);
+        void unpin(std::size_t frame_id, bool dirty);
+        std::size_t find(uint64_t page_id) const;
+        void *data(std::size_t frame_id) const;
+        Frame& frame(std::size_t frame_id);
+        std::size_t get_num_frames() const;
+    private:
+        std::size_t num_frames;
+        std::size_t page_size;
+        AlignedMemoryBlock memory;
+        std::vector<Frame> frames;
+        std::vector<std::size_t> free_frames;
+        PageTable page_table;
+        EvictionPolicy *policy;
+        std::mutex eviction_latch;
+};
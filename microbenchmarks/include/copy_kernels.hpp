@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+enum CopyIsa { COPY_ISA_SSE4_1, COPY_ISA_AVX2, COPY_ISA_AVX512 };
+enum CopyLoad { COPY_LOAD_TEMPORAL, COPY_LOAD_NT };
+enum CopyStore { COPY_STORE_TEMPORAL, COPY_STORE_NT, COPY_STORE_CLWB };
+
+// copies len bytes. Non-temporal loads need src, non-temporal stores and clwb need dest to be
+// mapped memory, the partial cache lines at either end of it are copied with memcpy and flushed.
+typedef void (*CopyKernel)(char *dest, const char *src, std::size_t len);
+
+// powers of two in between get a kernel with a compile-time trip count
+#define COPY_KERNEL_MIN_PAGE_SHIFT 12
+#define COPY_KERNEL_MAX_PAGE_SHIFT 16
+#define COPY_KERNEL_SIZES (COPY_KERNEL_MAX_PAGE_SHIFT - COPY_KERNEL_MIN_PAGE_SHIFT + 1)
+
+// the kernels of one instruction set and load/store type, looked up by length
+class CopyKernelTable {
+    public:
+        CopyKernelTable(CopyIsa isa, CopyLoad load, CopyStore store);
+        // the same kernel for every length
+        explicit CopyKernelTable(CopyKernel kernel);
+        CopyKernel get(std::size_t len) const {
+            if ((len & (len - 1)) == 0 && len >= (1 << COPY_KERNEL_MIN_PAGE_SHIFT) && len <= (1 << COPY_KERNEL_MAX_PAGE_SHIFT))
+                return sized[__builtin_ctzll(len) - COPY_KERNEL_MIN_PAGE_SHIFT];
+            return generic;
+        };
+    private:
+        CopyKernel sized[COPY_KERNEL_SIZES];
+        CopyKernel generic;
+};
+
+// kernels that can be chosen per run by name:
+// MEMCPY               std::memcpy
+// REP_MOVSB            rep movsb
+// SSE4_1, AVX2, AVX512 temporal loads and stores of that width
+// NT_LOAD              non-temporal loads, for reads from mapped memory
+// NT_STORE             non-temporal stores, for writes to mapped memory
+// CLWB                 temporal stores followed by clwb of every line
+// the vector kernels without a width use the widest the CPU supports
+CopyKernelTable copy_kernels_by_name(const std::string& name);
+
+enum FlushInstruction { FLUSH_CLFLUSH, FLUSH_CLFLUSHOPT, FLUSH_CLWB };
+
+// writes back every cache line of [addr, addr + len) to memory and fences the write-backs
+typedef void (*FlushFunction)(const char *addr, std::size_t len);
+
+FlushFunction flush_function(FlushInstruction instruction);
+// clwb keeps the lines cached, clflushopt invalidates them, clflush is also serialized with other flushes
+FlushInstruction detect_flush_instruction();
+const char *flush_instruction_name(FlushInstruction instruction);
+
+// the widest instruction set both the CPU and the OS (saving the registers on context switches) support
+CopyIsa detect_copy_isa();
+const char *copy_isa_name(CopyIsa isa);
+bool cpu_has_clwb();
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+struct DistributionConfig {
+    double zipf_theta;          // skew of the zipfian distributions, 0 < theta < 1
+    double hot_fraction;        // share of the pages in the hot set
+    double hot_operations;      // share of the accesses going to the hot set
+    uint64_t sequential_run;    // pages accessed in a row before jumping
+};
+
+// picks the pages a workload accesses, ids are in [0, num_pages)
+class PageDistribution {
+    public:
+        virtual ~PageDistribution() {};
+        virtual uint64_t next(std::mt19937& gen) = 0;
+        // page to write next, only differs for distributions that model inserts
+        virtual uint64_t next_write(std::mt19937& gen) { return next(gen); };
+};
+
+class UniformDistribution : public PageDistribution {
+    public:
+        UniformDistribution() = delete;
+        explicit UniformDistribution(uint64_t num_pages, const struct DistributionConfig& config);
+        uint64_t next(std::mt19937& gen) override;
+    private:
+        std::uniform_int_distribution<uint64_t> page_dis;
+};
+
+// Gray et al., "Quickly Generating Billion-Record Synthetic Databases", as used by YCSB.
+// page 0 is the most popular one, page 1 the second most popular one and so on.
+class ZipfianDistribution : public PageDistribution {
+    public:
+        ZipfianDistribution() = delete;
+        explicit ZipfianDistribution(uint64_t num_pages, const struct DistributionConfig& config);
+        uint64_t next(std::mt19937& gen) override;
+    private:
+        uint64_t num_pages;
+        double theta;
+        double zetan;
+        double alpha;
+        double eta;
+        std::uniform_real_distribution<> uniform_dis;
+};
+
+// zipfian popularity, but the popular pages are hashed all over the buffer
+class ScrambledZipfianDistribution : public PageDistribution {
+    public:
+        ScrambledZipfianDistribution() = delete;
+        explicit ScrambledZipfianDistribution(uint64_t num_pages, const struct DistributionConfig& config);
+        uint64_t next(std::mt19937& gen) override;
+    private:
+        uint64_t num_pages;
+        ZipfianDistribution zipf;
+};
+
+// writes append at a moving frontier, reads are zipfian by distance to the frontier (YCSB "latest")
+class LatestDistribution : public PageDistribution {
+    public:
+        LatestDistribution() = delete;
+        explicit LatestDistribution(uint64_t num_pages, const struct DistributionConfig& config);
+        uint64_t next(std::mt19937& gen) override;
+        uint64_t next_write(std::mt19937& gen) override;
+    private:
+        uint64_t num_pages;
+        uint64_t frontier;
+        ZipfianDistribution zipf;
+};
+
+// hot_operations of the accesses go to the first hot_fraction of the pages, e.g. 80/20
+class HotSetDistribution : public PageDistribution {
+    public:
+        HotSetDistribution() = delete;
+        explicit HotSetDistribution(uint64_t num_pages, const struct DistributionConfig& config);
+        uint64_t next(std::mt19937& gen) override;
+    private:
+        double hot_operations;
+        std::uniform_real_distribution<> hot_dis;
+        std::uniform_int_distribution<uint64_t> hot_page_dis;
+        std::uniform_int_distribution<uint64_t> cold_page_dis;
+};
+
+// runs of sequential_run consecutive pages, each starting at a random page
+class SequentialDistribution : public PageDistribution {
+    public:
+        SequentialDistribution() = delete;
+        explicit SequentialDistribution(uint64_t num_pages, const struct DistributionConfig& config);
+        uint64_t next(std::mt19937& gen) override;
+    private:
+        uint64_t num_pages;
+        uint64_t sequential_run;
+        uint64_t position;
+        uint64_t remaining;
+        std::uniform_int_distribution<uint64_t> page_dis;
+};
+
+template<typename Distribution>
+PageDistribution *create_page_distribution(uint64_t num_pages, const struct DistributionConfig& config) {
+    return new Distribution{num_pages, config};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// sub-buckets per power of two, 2^6 keeps the relative error below 1.6%
+#define HISTOGRAM_SUB_BUCKET_BITS 6
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS + (64 - HISTOGRAM_SUB_BUCKET_BITS) * HISTOGRAM_SUB_BUCKETS)
+
+inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// log-linear latency histogram in the style of HdrHistogram: values below HISTOGRAM_SUB_BUCKETS
+// are counted exactly, every larger power of two is split into HISTOGRAM_SUB_BUCKETS buckets.
+// Not thread-safe, every thread records into its own histogram and they are merged afterwards.
+class LatencyHistogram {
+    public:
+        LatencyHistogram();
+        void record(uint64_t value) {
+            buckets[bucket_of(value)]++;
+            count++;
+            sum += value;
+            if (value > max) max = value;
+            if (value < min) min = value;
+        };
+        void merge(const LatencyHistogram& other);
+        // upper bound of the bucket the p-th percentile (0 to 100) falls into
+        uint64_t percentile(double p) const;
+        uint64_t get_count() const;
+        uint64_t get_max() const;
+        uint64_t get_min() const;
+        double get_mean() const;
+    private:
+        static std::size_t bucket_of(uint64_t value) {
+            if (value < HISTOGRAM_SUB_BUCKETS) return value;
+            int msb = 63 - __builtin_clzll(value);
+            int shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+            return HISTOGRAM_SUB_BUCKETS + static_cast<std::size_t>(shift) * HISTOGRAM_SUB_BUCKETS + ((value >> shift) - HISTOGRAM_SUB_BUCKETS);
+        };
+        static uint64_t bucket_upper_bound(std::size_t bucket);
+        std::vector<uint64_t> buckets;
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        uint64_t min;
+};
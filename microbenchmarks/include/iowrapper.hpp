@@ -2,14 +2,37 @@
 
 #include <string>
 #include <cstdio>
+#include <functional>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include "copy_kernels.hpp"
 
 #ifdef __linux
 #include <libpmem2.h>
 #include <libpmemlog.h>
+#include <liburing.h>
 #endif
 
 #define BUFFER_FILE_BASENAME "/buffer.bin."
 
+// how the LINUX and STD engines make written pages durable
+enum Durability {
+    DURABILITY_NONE,            // leave it to the page cache
+    DURABILITY_FDATASYNC,       // fdatasync after every write
+    DURABILITY_O_DSYNC,         // open the file with O_DSYNC
+    DURABILITY_RWF_DSYNC,       // pwritev2 with RWF_DSYNC, LINUX only
+    DURABILITY_SYNC_FILE_RANGE, // start writeback per write, wait for it once per window
+    DURABILITY_GROUP            // one fdatasync for a group of writes
+};
+
+struct DurabilityConfig {
+    Durability mode;
+    unsigned int sync_every; // written pages per window/group, batches count each of their pages
+    uint64_t sync_interval_us; // also sync once this much time passed since the last sync, 0 disables
+};
+
 struct IOWrapperConfig {
     const char *directory;
     const char *file_suffix;
@@ -22,6 +45,48 @@ struct IOWrapperConfig {
     bool madv_random;
     bool madv_sequential;
     bool mmap_populate;
+    bool uring_sqpoll;
+    unsigned int queue_depth;
+    struct DurabilityConfig durability;
+    // copy kernels of the DAX engines (see copy_kernels.hpp), empty for the engine's default
+    const char *read_kernel;
+    const char *write_kernel;
+};
+
+// tracks the writes of one file descriptor and syncs them according to its DurabilityConfig
+class DurabilityPolicy {
+    public:
+        DurabilityPolicy();
+        explicit DurabilityPolicy(const struct DurabilityConfig& config);
+        // added to the flags the file is opened with
+        int open_flags() const;
+        // flags for pwritev2, 0 if a plain write suffices
+        int write_flags() const;
+        // writes have to have left user space buffers before written() is called
+        bool needs_flush() const;
+        // writes is the number of pages written to position..position+len. A batch only syncs once,
+        // so a group is closed at the end of the batch that reaches sync_every pages.
+        void written(int fd, std::size_t position, std::size_t len, std::size_t writes, const std::string& filename);
+        // syncs what is still pending, called before the file is closed
+        void finish(int fd, const std::string& filename);
+    private:
+        void sync(int fd, const std::string& filename);
+        struct DurabilityConfig config;
+        std::size_t pending; // pages written since the last sync
+        uint64_t last_sync_ns;
+};
+
+struct IOCompletion {
+    uint64_t tag;
+    bool is_write;
+    int result;
+};
+
+// one page of a batch
+struct IORequest {
+    void *buf;
+    std::size_t position;
+    std::size_t len;
 };
 
 class IOWrapper {
@@ -29,10 +94,30 @@ class IOWrapper {
         virtual ~IOWrapper() {}; // virtual destructors need implementations
         virtual int read(void *dest, std::size_t position, std::size_t len) = 0;
         virtual int write(void *src, std::size_t position, std::size_t len) = 0;  
+        // engines that can make use of pre-registered memory (io_uring) override this
+        virtual void register_buffers(const std::vector<struct iovec>&) {};
+
+        // asynchronous interface: blocking engines complete requests inline on submission,
+        // queue-based engines only hand them to the device once poll/wait is called
+        virtual int submit_read(void *dest, std::size_t position, std::size_t len, uint64_t tag);
+        virtual int submit_write(void *src, std::size_t position, std::size_t len, uint64_t tag);
+        virtual std::size_t poll(std::vector<IOCompletion>& completions);
+        virtual std::size_t wait(std::vector<IOCompletion>& completions, std::size_t min_completions);
+        virtual std::size_t inflight() const;
+
+        // the whole batch is done on return and as durable as the engine's durability policy makes
+        // its writes, it may be reordered. Engines that can coalesce adjacent requests or persist
+        // once per batch override these, the others issue the requests one after another.
+        virtual int read_batch(std::vector<IORequest>& batch);
+        virtual int write_batch(std::vector<IORequest>& batch);
+
         uint32_t get_alignment();
         uintmax_t get_filesize() const;
     protected:
+        std::vector<IOCompletion> completed;
         virtual const char *get_filename() const = 0;
+        // sorts the batch by position and calls run(first, last) for every range of adjacent requests
+        static void for_each_run(std::vector<IORequest>& batch, std::size_t max_run, const std::function<void(std::size_t, std::size_t)>& run);
 };
 
 class LinuxIOWrapper : public IOWrapper {
@@ -42,10 +127,15 @@ class LinuxIOWrapper : public IOWrapper {
         ~LinuxIOWrapper() override;
         int read(void *dest, std::size_t position, std::size_t len) override; 
         int write(void *src, std::size_t position, std::size_t len) override;
+        // adjacent pages are read/written with a single preadv/pwritev, the batch is synced once
+        int read_batch(std::vector<IORequest>& batch) override;
+        int write_batch(std::vector<IORequest>& batch) override;
 
     protected:
         int fd;
         std::string bufferFilename;
+        DurabilityPolicy durability;
+        std::vector<struct iovec> iovecs;
         const char *get_filename() const override;
         virtual int open_flags();
         virtual void handle_write_error();
@@ -66,6 +156,8 @@ class MmapIOWrapper : public IOWrapper {
         ~MmapIOWrapper() override;
         int read(void *dest, std::size_t position, std::size_t len) override; 
         int write(void *src, std::size_t position, std::size_t len) override;
+        // one msync per range of adjacent pages
+        int write_batch(std::vector<IORequest>& batch) override;
 
     protected:
         int fd;
@@ -73,10 +165,32 @@ class MmapIOWrapper : public IOWrapper {
         int mempagesize;
         std::size_t map_length;
         std::string bufferFilename;
+        CopyKernelTable read_kernels;
+        CopyKernelTable write_kernels;
         virtual int open_flags();
         const char *get_filename() const override;
 };
 
+// persists writes by flushing the cache lines from user space instead of msync, which only
+// makes them durable if the file is on DAX and mapped with MAP_SYNC
+class FlushingMmapIOWrapper : public MmapIOWrapper {
+    public:
+        FlushingMmapIOWrapper(struct IOWrapperConfig&);
+        int write(void *src, std::size_t position, std::size_t len) override;
+        int write_batch(std::vector<IORequest>& batch) override;
+    protected:
+        FlushFunction flush;
+};
+
+// for platforms with eADR, where the caches are in the persistence domain and a fence suffices
+class EadrMmapIOWrapper : public MmapIOWrapper {
+    public:
+        EadrMmapIOWrapper(struct IOWrapperConfig&);
+        int write(void *src, std::size_t position, std::size_t len) override;
+        // a single fence for the whole batch
+        int write_batch(std::vector<IORequest>& batch) override;
+};
+
 class STDIOWrapper : public IOWrapper {
     public:
         STDIOWrapper() = default;
@@ -89,8 +203,68 @@ class STDIOWrapper : public IOWrapper {
         std::FILE *f;
         int fd;
         std::string bufferFilename;
+        DurabilityPolicy durability;
+        const char *get_filename() const override;
+};
+
+#ifdef __linux
+class IoUringIOWrapper : public IOWrapper {
+    public:
+        IoUringIOWrapper() = default;
+        IoUringIOWrapper(struct IOWrapperConfig&);
+        ~IoUringIOWrapper() override;
+        int read(void *dest, std::size_t position, std::size_t len) override; 
+        int write(void *src, std::size_t position, std::size_t len) override;
+        void register_buffers(const std::vector<struct iovec>& buffers) override;
+        int submit_read(void *dest, std::size_t position, std::size_t len, uint64_t tag) override;
+        int submit_write(void *src, std::size_t position, std::size_t len, uint64_t tag) override;
+        std::size_t poll(std::vector<IOCompletion>& completions) override;
+        std::size_t wait(std::vector<IOCompletion>& completions, std::size_t min_completions) override;
+        std::size_t inflight() const override;
+        // the batch goes out with one submission, its writes are followed by a single fdatasync.
+        // Batches larger than the queue depth are submitted in chunks of it.
+        int read_batch(std::vector<IORequest>& batch) override;
+        int write_batch(std::vector<IORequest>& batch) override;
+
+    protected:
+        struct Request {
+            uint64_t tag;
+            std::size_t position;
+            std::size_t len;
+            bool is_write;
+            bool blocking;
+            // writes are only done once the fdatasync linked to them is, batch writes share one
+            bool synced;
+        };
+        int fd;
+        struct io_uring ring;
+        std::vector<struct iovec> fixed_buffers;
+        std::vector<Request> requests;
+        std::vector<unsigned int> free_requests;
+        unsigned int unsubmitted;
+        unsigned int blocking_pending;
+        std::string bufferFilename;
+        void setup(struct IOWrapperConfig&);
+        int fixed_buffer_index(void *addr, std::size_t len) const;
+        unsigned int acquire_request();
+        void prepare(unsigned int request_id, void *buf);
+        void prepare_sync(unsigned int request_id);
+        void wait_blocking();
+        void flush_submissions();
+        bool reap(bool block);
         const char *get_filename() const override;
+        virtual int open_flags();
+        virtual void handle_write_error();
+};
+
+class DirectIoUringIOWrapper : public IoUringIOWrapper {
+    public:
+        DirectIoUringIOWrapper(struct IOWrapperConfig&);
+    protected:
+        int open_flags() override;
+        void handle_write_error() override;
 };
+#endif
 
 #ifdef __linux
 class LibPMIOWrapper : public IOWrapper {
@@ -100,6 +274,8 @@ class LibPMIOWrapper : public IOWrapper {
         ~LibPMIOWrapper() override;
         int read(void *dest, std::size_t position, std::size_t len) override; 
         int write(void *src, std::size_t position, std::size_t len) override;
+        // flushes every page but drains only once for the whole batch
+        int write_batch(std::vector<IORequest>& batch) override;
 
     protected:
         int fd;
@@ -108,6 +284,13 @@ class LibPMIOWrapper : public IOWrapper {
         struct pmem2_source* pmsrc;
         pmem2_memcpy_fn pmmemcpy_fn;
         pmem2_persist_fn pmpersist_fn;
+        pmem2_flush_fn pmflush_fn;
+        pmem2_drain_fn pmdrain_fn;
+        // writes either go through pmmemcpy_fn with these flags or the write kernel and pmpersist_fn
+        bool use_pmem2_memcpy;
+        unsigned int pmem2_memcpy_flags;
+        CopyKernelTable read_kernels;
+        CopyKernelTable write_kernels;
         void *map_addr;
         std::string bufferFilename;
         virtual int open_flags();
@@ -116,6 +299,7 @@ class LibPMIOWrapper : public IOWrapper {
 #endif
 
 
+// copies with non-temporal loads/stores, using the widest of AVX-512, AVX2 and SSE4.1 the CPU supports
 class ASMIOWrapper : public IOWrapper {
     public:
         ASMIOWrapper() = default;
@@ -123,7 +307,11 @@ class ASMIOWrapper : public IOWrapper {
         ~ASMIOWrapper() override;
         int read(void *dest, std::size_t position, std::size_t len) override; 
         int write(void *src, std::size_t position, std::size_t len) override;
+        // the instruction set the copy kernels were selected for
+        static const char *get_isa();
     protected:
+        CopyKernelTable read_kernels;
+        CopyKernelTable write_kernels;
         int fd;
         char *map_addr;
         int mempagesize;
@@ -133,6 +321,12 @@ class ASMIOWrapper : public IOWrapper {
         const char *get_filename() const override;
 };
 
+// writes with regular stores and clwb instead of non-temporal stores, the lines stay cached
+class ClwbASMIOWrapper : public ASMIOWrapper {
+    public:
+        ClwbASMIOWrapper(struct IOWrapperConfig&);
+};
+
 template<typename Wrapper>
 IOWrapper *create_io_wrapper(struct IOWrapperConfig& config) {
     return new Wrapper{config};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define OPERATION_STREAM_MAGIC 0x314d41455254534fULL // "OSTREAM1"
+
+// one page access of the bufman workload. Writes take random_page_pool[pool_page], set the byte
+// at offset to value and write the result to page_id.
+struct Operation {
+    uint64_t page_id;
+    uint32_t offset;
+    uint16_t pool_page;
+    uint8_t is_write;
+    uint8_t value;
+};
+
+// header of a persisted stream, the operations follow right after it
+struct OperationStreamHeader {
+    uint64_t magic;
+    uint64_t num_operations;
+    uint64_t num_pages;
+    uint64_t page_size;
+    uint64_t random_pages;
+    uint64_t reserved[3];
+};
+
+// operations generated before the benchmark, either kept in memory or memory-mapped from a file
+// so the identical sequence can be replayed with other engines or on other machines
+class OperationStream {
+    public:
+        OperationStream() = delete;
+        // in-memory stream, filled by the caller through data()
+        explicit OperationStream(const struct OperationStreamHeader& header);
+        // maps a stream written by save()
+        explicit OperationStream(const std::string& filename);
+        ~OperationStream();
+        OperationStream(const OperationStream&) = delete;
+        OperationStream& operator=(const OperationStream&) = delete;
+        void save(const std::string& filename) const;
+        const struct OperationStreamHeader& get_header() const;
+        Operation *data();
+        const Operation& operator[](std::size_t i) const { return operations[i]; };
+        std::size_t size() const { return header.num_operations; };
+    private:
+        struct OperationStreamHeader header;
+        std::vector<Operation> generated;
+        void *map_addr;
+        std::size_t map_length;
+        Operation *operations;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// version counter that is odd while a writer holds it. Readers never write to it, they
+// remember the version before reading and retry if it changed in the meantime.
+class OptimisticLatch {
+    public:
+        uint64_t read_begin() const;
+        bool read_validate(uint64_t version) const;
+        void lock();
+        void unlock();
+    private:
+        std::atomic<uint64_t> version{0};
+};
+
+// page id -> frame id map for the buffer pool. Pages are split into one group per mount by
+// page_id % mounts, the default placement of BufferManager, and each group is further split into
+// sub-partitions. Every sub-partition is an open-addressing (linear probing) hash table guarded
+// by an OptimisticLatch, so lookups are lock-free and only inserts/erases take the latch.
+class PageTable {
+    public:
+        PageTable() = delete;
+        explicit PageTable(std::size_t expected_entries, std::size_t num_mounts);
+        // returns INVALID_FRAME_ID if page_id is not in the table
+        std::size_t lookup(uint64_t page_id) const;
+        // returns false (and does not change anything) if page_id already is in the table
+        bool insert(uint64_t page_id, std::size_t frame_id);
+        void erase(uint64_t page_id);
+    private:
+        struct Slot {
+            std::atomic<uint64_t> key;
+            std::atomic<uint64_t> value;
+        };
+        struct Table {
+            explicit Table(std::size_t capacity);
+            std::size_t mask;
+            std::unique_ptr<Slot[]> slots;
+        };
+        struct alignas(64) Partition {
+            OptimisticLatch latch;
+            std::atomic<Table*> table;
+            std::size_t used;
+            std::size_t tombstones;
+            // tables replaced by a larger one stay alive until the page table is destroyed, readers
+            // might still probe them. Rebuilds that keep the capacity rehash in place.
+            std::vector<std::unique_ptr<Table>> tables;
+        };
+        Partition& partition_of(uint64_t page_id) const;
+        void grow(Partition& p);
+        // inserts key into a table that has room for it and no tombstones
+        static void place(Table& t, uint64_t key, uint64_t value);
+        static uint64_t hash(uint64_t key);
+        std::size_t num_mounts;
+        std::size_t partitions_per_mount;
+        std::unique_ptr<Partition[]> partitions;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum PerfCounterScope { PERF_COUNTERS_THREAD, PERF_COUNTERS_PROCESS };
+
+// cycles, instructions, LLC and dTLB misses, page faults and context switches via perf_event_open.
+// PERF_COUNTERS_THREAD counts the calling thread only. PERF_COUNTERS_PROCESS sets inherit, so
+// threads spawned after start() are counted as well; their counts are added once they are joined.
+// Counters the kernel or the CPU does not offer are skipped with a warning.
+class PerfCounters {
+    public:
+        explicit PerfCounters(PerfCounterScope scope);
+        ~PerfCounters();
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+        void start();
+        void stop();
+        // counts of the opened counters, scaled up if the kernel had to multiplex them
+        const std::vector<std::pair<std::string, uint64_t>>& get_counts() const;
+    private:
+        std::vector<int> fds;
+        std::vector<std::pair<std::string, uint64_t>> counts;
+};
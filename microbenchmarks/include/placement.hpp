@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct PlacementConfig {
+    uint64_t stripe_pages;      // pages in a row on one mount before moving on to the next
+    std::vector<double> weights; // relative share of each mount, e.g. its bandwidth, weighted striping only
+};
+
+// where the pages of the buffer live: maps a page id to a mount and the page within that mount's
+// buffer file. Every mount holds pages_per_mount pages, every page id maps to a different place.
+class PagePlacement {
+    public:
+        virtual ~PagePlacement() {};
+        virtual void place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const = 0;
+        // page ids are in [0, get_num_pages()), placements that do not fill every mount have fewer
+        // than num_mounts * pages_per_mount
+        virtual uint64_t get_num_pages() const = 0;
+};
+
+// round robin in stripe units of stripe_pages, a stripe unit of 1 interleaves single pages. If
+// the buffer files are no multiple of the stripe unit, the pages behind the last full stripe
+// are interleaved one by one.
+class StripedPlacement : public PagePlacement {
+    public:
+        StripedPlacement() = delete;
+        explicit StripedPlacement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig& config);
+        void place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const override;
+        uint64_t get_num_pages() const override;
+    private:
+        std::size_t num_mounts;
+        uint64_t pages_per_mount;
+        uint64_t stripe_pages;
+        uint64_t full_stripes; // per mount
+        uint64_t striped_pages;
+};
+
+// the first pages_per_mount pages on the first mount, the next ones on the second and so on
+class RangePlacement : public PagePlacement {
+    public:
+        RangePlacement() = delete;
+        explicit RangePlacement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig& config);
+        void place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const override;
+        uint64_t get_num_pages() const override;
+    private:
+        std::size_t num_mounts;
+        uint64_t pages_per_mount;
+};
+
+// scatters the pages pseudo-randomly over the mounts and within them. A Feistel network permutes
+// the page ids, ids outside of the buffer are permuted again until they fall into it.
+class HashPlacement : public PagePlacement {
+    public:
+        HashPlacement() = delete;
+        explicit HashPlacement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig& config);
+        void place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const override;
+        uint64_t get_num_pages() const override;
+    private:
+        uint64_t permute(uint64_t page_id) const;
+        std::size_t num_mounts;
+        uint64_t num_pages;
+        unsigned int half_bits;
+        uint64_t half_mask;
+};
+
+// striping where every mount gets stripe units in proportion to its weight, spread evenly over
+// a round (weights 2:1 place units as A B A). The mount with the largest share fills up first,
+// the rest of the other mounts stays unused.
+class WeightedPlacement : public PagePlacement {
+    public:
+        WeightedPlacement() = delete;
+        explicit WeightedPlacement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig& config);
+        void place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const override;
+        uint64_t get_num_pages() const override;
+    private:
+        uint64_t stripe_pages;
+        uint64_t round_pages;
+        uint64_t num_pages;
+        std::vector<uint64_t> units;
+        // mount of every stripe unit of a round and which of that mount's units of the round it is
+        std::vector<std::size_t> unit_mount;
+        std::vector<uint64_t> unit_index;
+};
+
+template<typename Placement>
+PagePlacement *create_page_placement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig& config) {
+    return new Placement{num_mounts, pages_per_mount, config};
+}
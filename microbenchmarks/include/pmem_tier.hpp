@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "buffer_pool.hpp"
+#include "iowrapper.hpp"
+#include "page_table.hpp"
+
+struct TierConfig {
+    uint32_t promote_after; // accesses after which a page is copied into the tier
+    bool read_in_place; // reads of pages not in DRAM are copied straight out of the tier instead of through a frame
+};
+
+struct TierStats {
+    uint64_t hits; // DRAM misses served from the tier
+    uint64_t in_place_reads;
+    uint64_t promotions;
+    uint64_t demotions;
+    uint64_t writebacks; // demoted pages written back to the buffer files
+};
+
+// middle tier between the DRAM buffer pool and the buffer files: one file, normally on PMem,
+// divided into slots that hold copies of pages. Pages are counted on every access and copied into
+// a slot once they were accessed promote_after times, the slots are reclaimed with a CLOCK that
+// halves the count of every page it passes, so pages that stop being accessed get demoted first.
+// All counts are halved whenever as many pages were promoted as the tier has slots, so a page has
+// to be accessed promote_after times within roughly one turnover of the tier to be promoted.
+// Counting costs a store into one array shared by all threads on every access, pool hits included.
+// Like the pool, the tier is shared by the buffer managers of all threads and does no I/O on
+// their behalf except through its own wrapper, which therefore has to be safe to call from several
+// threads at once. The mapping engines are, as they only copy from and to the mapping.
+// Slots reuse the frame bookkeeping of the pool: the state is the pin count or FRAME_LOCKED,
+// a dirty slot holds a newer version of its page than the buffer files.
+class PMemTier {
+    public:
+        PMemTier() = delete;
+        explicit PMemTier(IOWrapper *wrapper, std::size_t num_slots, std::size_t page_size, uint64_t num_pages, std::size_t num_mounts, const struct TierConfig& config);
+        // counts an access of page_id
+        void touch(uint64_t page_id);
+        bool is_hot(uint64_t page_id) const;
+        bool contains(uint64_t page_id) const;
+        // pins page_id if it is in the tier and returns its slot, INVALID_FRAME_ID otherwise.
+        // waits if the slot is being written.
+        std::size_t pin_resident(uint64_t page_id);
+        // like pin_resident, but locks the slot to overwrite it, waiting for readers to unpin it
+        std::size_t lock_resident(uint64_t page_id);
+        // returns a locked slot that is still mapped to its old page, which has to be written back
+        // if the slot is dirty. INVALID_FRAME_ID if every slot is in use right now.
+        std::size_t demote();
+        // maps page_id to the locked slot_id. Returns false if page_id already has a slot.
+        bool install(std::size_t slot_id, uint64_t page_id);
+        // unlocks a slot, dirty if it was just written with a page the buffer files do not have yet
+        void release(std::size_t slot_id, bool dirty);
+        void unpin(std::size_t slot_id);
+        bool try_lock(std::size_t slot_id);
+        int read(std::size_t slot_id, void *dest);
+        int write(std::size_t slot_id, void *src);
+        Frame& slot(std::size_t slot_id);
+        std::size_t get_num_slots() const;
+        uint32_t get_alignment();
+        const struct TierConfig& get_config() const;
+    private:
+        std::unique_ptr<IOWrapper> wrapper;
+        std::size_t num_slots;
+        std::size_t page_size;
+        uint64_t num_pages;
+        struct TierConfig config;
+        std::unique_ptr<std::atomic<uint8_t>[]> access_counts;
+        std::atomic<std::size_t> promotions_since_aging;
+        // halves every access count
+        void age();
+        std::vector<Frame> slots;
+        std::vector<std::size_t> free_slots;
+        PageTable page_table;
+        std::size_t hand;
+        std::mutex demotion_latch;
+};
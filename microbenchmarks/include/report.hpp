@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct ReportEntry {
+    std::string name;
+    std::string value;
+    bool is_string;
+};
+
+// collects the options, metrics and machine metadata of a run and writes them as JSON or CSV.
+// Entries keep the display names bufman logs, the files use snake_case keys derived from them.
+class Report {
+    public:
+        // all add functions return the value as it is logged
+        const std::string& add(const std::string& section, const std::string& name, const std::string& value);
+        const std::string& add(const std::string& section, const std::string& name, const char *value);
+        const std::string& add(const std::string& section, const std::string& name, bool value);
+        template<typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+        const std::string& add(const std::string& section, const std::string& name, T value) {
+            return add_entry(section, {name, std::to_string(value), false});
+        }
+        // machine metadata of one mount, reported as a list
+        void add_mount(const std::vector<ReportEntry>& mount);
+        // JSON unless filename ends with .csv. CSV files get one row per run, appended if the file exists.
+        void write(const std::string& filename) const;
+        void write_json(const std::string& filename) const;
+        void write_csv(const std::string& filename) const;
+        static std::string key(const std::string& name);
+        // the entries added to section so far, empty if there are none
+        std::vector<ReportEntry> get(const std::string& section) const;
+    private:
+        const std::string& add_entry(const std::string& section, ReportEntry entry);
+        std::vector<std::pair<std::string, std::vector<ReportEntry>>> sections;
+        std::vector<std::vector<ReportEntry>> mounts;
+};
+
+// CPU model, kernel, host and, for every directory, the filesystem it is on and whether it uses DAX
+void collect_machine_info(Report& report, const std::vector<std::string>& directories);
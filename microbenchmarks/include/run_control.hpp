@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+enum RunPhase { RUN_WARMUP, RUN_MEASURE, RUN_DONE };
+
+struct RunControlConfig {
+    double duration; // s measured, 0 stops the workloads after their total workload instead
+    double warmup; // s before the measurement starts at the earliest
+    bool steady_state; // additionally wait for the throughput to become stable
+    double window; // s per throughput sample
+    unsigned int windows; // samples the variation is computed over
+    double max_variation; // coefficient of variation of the samples below which the throughput is stable
+    double max_warmup; // s after which the measurement starts even if the throughput never got stable
+};
+
+// without duration, warm-up and steady-state detection workloads just run until their total workload
+bool is_controlled(const struct RunControlConfig& config);
+
+// moves the workloads of a run from warm-up to measurement to done. The workloads poll the phase,
+// monitor() runs on its own thread and samples their throughput.
+class RunControl {
+    public:
+        RunControl() = delete;
+        explicit RunControl(const struct RunControlConfig& config);
+        RunPhase get_phase() const { return phase.load(std::memory_order_acquire); };
+        bool is_time_bounded() const { return config.duration > 0; };
+        // returns once finished() is true. progress() is the data all workloads processed so far,
+        // including the warm-up.
+        void monitor(const std::function<uint64_t()>& progress, const std::function<bool()>& finished);
+        // when the measurement started, the end of the run if it never did
+        uint64_t get_measure_start_ns() const;
+        double get_warmup_time() const;
+        // false if the warm-up ended because of max_warmup
+        bool reached_steady_state() const;
+    private:
+        bool stable() const;
+        void start_measurement(uint64_t now);
+        struct RunControlConfig config;
+        std::atomic<RunPhase> phase;
+        uint64_t start_ns;
+        uint64_t measure_start_ns;
+        bool steady;
+        std::vector<double> samples;
+};
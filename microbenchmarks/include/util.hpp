@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <string>
 #include <random>
+#include <vector>
 
 namespace bmlog {
     void debug(const char *msg, bool flush = true);
@@ -23,6 +24,9 @@ std::mt19937 CustomSeededEngine(uint32_t seed);
 
 uint32_t suffix_to_seed(std::string suffix);
 
+// the non-empty items of a comma separated list
+std::vector<std::string> split_list(const std::string& list);
+
 class AlignedMemoryBlock {
     public:
         AlignedMemoryBlock() = delete;
@@ -1,27 +1,95 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "arrivals.hpp"
 #include "buffer_manager.hpp"
+#include "distribution.hpp"
+#include "histogram.hpp"
+#include "operation_stream.hpp"
+#include "run_control.hpp"
 #include "util.hpp"
 
 class Workload {
     public:
         virtual ~Workload() {};
         virtual void run() = 0;
+        // without a run control, the workload runs until its total workload is processed
+        void set_run_control(RunControl *run_control);
+        // what was processed after the warm-up
+        uint64_t get_processed_data() const { return processed_data - warmup_data; };
+        // pages, log entries or YCSB operations, whatever the workload counts as one unit of work
+        uint64_t get_processed_operations() const { return processed_operations - warmup_operations; };
+        // everything processed so far, including the warm-up. Can be read while the workload runs.
+        uint64_t get_progress() const { return progress.load(std::memory_order_relaxed); };
+        uint64_t get_total_data() const { return processed_data; };
+        uint64_t get_total_operations() const { return processed_operations; };
+        // completed operations per type, for workloads that have more than one kind
+        virtual std::vector<std::pair<std::string, uint64_t>> get_operation_counts() const { return {}; };
+        // latencies the workload measures itself, on top of those of its buffer manager
+        virtual std::vector<std::pair<std::string, const LatencyHistogram*>> get_latencies() const;
+        void set_latency_tracking(bool enabled) { track_latency = enabled; };
+        // issues the operations open-loop at the times of the schedule instead of back to back
+        void set_arrival_schedule(std::unique_ptr<ArrivalSchedule> schedule) { arrivals = std::move(schedule); };
+    protected:
+        // bracket every operation. Open-loop, begin_operation() waits for the operation's arrival and
+        // end_operation() records its response time from the arrival and its service time from
+        // when it actually started.
+        void begin_operation() {
+            if (!arrivals) return;
+            arrival_ns = arrivals->wait_next();
+            if (track_latency) start_ns = now_ns();
+        };
+        void end_operation() {
+            if (!arrivals || !track_latency) return;
+            uint64_t end = now_ns();
+            response_latency.record(end - arrival_ns);
+            service_latency.record(end - start_ns);
+        };
+        // whether to go on after data bytes of total_workload have been processed (or submitted)
+        bool more(uint64_t data, std::size_t total_workload);
+        // the warm-up is over, latencies and counts collected so far have to be dropped
+        virtual void begin_measurement() {};
+        uint64_t processed_data = 0;
+        uint64_t processed_operations = 0;
+        bool track_latency = true;
+    private:
+        RunControl *run_control = nullptr;
+        RunPhase phase = RUN_MEASURE;
+        uint64_t warmup_data = 0;
+        uint64_t warmup_operations = 0;
+        std::atomic<uint64_t> progress{0};
+        std::unique_ptr<ArrivalSchedule> arrivals;
+        uint64_t arrival_ns = 0;
+        uint64_t start_ns = 0;
+        LatencyHistogram response_latency;
+        LatencyHistogram service_latency;
 };
 
 class BufferManagementWorkload: public Workload {
     public:
         BufferManagementWorkload() = delete;
-        explicit BufferManagementWorkload(BufferManager& bm, std::size_t total_workload, float write_proportion, int random_pages, uint32_t pattern_seed, uint64_t target_pages);
+        explicit BufferManagementWorkload(BufferManager& bm, std::size_t total_workload, float write_proportion, int random_pages, uint32_t pattern_seed, uint64_t target_pages, unsigned int queue_depth, PageDistribution *page_distribution);
         void run() final;
+        // generates all operations up front so the timed loop does not call the RNG. With a
+        // stream_file, an existing stream is replayed or a new one is saved there.
+        void pregenerate_operations(const std::string& stream_file);
+    protected:
+        void begin_measurement() override;
     private:
+        Operation generate_operation();
+        Operation next_operation();
+        void run_async(char *read_target, uint64_t read_target_pages);
+        void run_pooled(char *read_target, uint64_t read_target_pages);
         std::mt19937& gen();
         bool do_write();
-        uint64_t next_page_id();
+        uint64_t next_page_id(bool write);
         int next_random_pagepool_id();
         int next_random_data();
         int next_random_position(int maxval);
@@ -31,30 +99,108 @@ class BufferManagementWorkload: public Workload {
         uint32_t pattern_seed;
         uint64_t target_pages;
         uint64_t max_page_id;
+        unsigned int queue_depth;
         std::vector<AlignedMemoryBlock> random_page_pool;
+        std::unique_ptr<PageDistribution> page_distribution;
+        std::unique_ptr<OperationStream> operation_stream;
+        std::size_t next_operation_index = 0;
+        std::mt19937 generator;
+        std::uniform_real_distribution<> write_dis;
+        std::uniform_int_distribution<int> pagepool_dis;
+        std::uniform_int_distribution<int> data_dis;
+};
+
+enum YcsbOperation { YCSB_READ, YCSB_UPDATE, YCSB_INSERT, YCSB_SCAN, YCSB_RMW, YCSB_NUM_OPERATIONS };
+
+// operation proportions of a YCSB core workload, summing up to 1
+struct YcsbMix {
+    double proportions[YCSB_NUM_OPERATIONS];
+    // requests go to recently inserted records instead of being (scrambled) zipfian
+    bool latest;
+};
+
+// YCSB core workload with A to F selecting the mix
+struct YcsbMix ycsb_mix(char workload);
+
+// YCSB over fixed-size records packed into the pages of the buffer. Record r lives in page
+// r / records_per_page, so everything smaller than a page is read-modify-write.
+// record_count is shared by all threads so inserts append to the same end.
+class YcsbWorkload: public Workload {
+    public:
+        YcsbWorkload() = delete;
+        explicit YcsbWorkload(BufferManager& bm, std::size_t total_workload, struct YcsbMix mix, std::size_t record_size, uint64_t max_scan_length, uint32_t pattern_seed, const struct DistributionConfig& distribution_config, std::shared_ptr<std::atomic<uint64_t>> record_count);
+        void run() final;
+        std::vector<std::pair<std::string, uint64_t>> get_operation_counts() const override;
+    protected:
+        void begin_measurement() override;
+    private:
+        YcsbOperation next_operation();
+        uint64_t next_record();
+        // records that exist right now, at most record_capacity once inserts wrapped around
+        uint64_t live_records() const;
+        char *fetch_page(uint64_t page_id, char *buf);
+        void release_page(uint64_t page_id, char *page, bool dirty);
+        void read(uint64_t record);
+        void update(uint64_t record, bool read_first);
+        void insert();
+        void scan(uint64_t first_record);
+        BufferManager& bm;
+        std::size_t total_workload;
+        struct YcsbMix mix;
+        std::size_t record_size;
+        uint64_t records_per_page;
+        uint64_t record_capacity;
+        uint64_t max_scan_length;
+        uint32_t pattern_seed;
+        std::shared_ptr<std::atomic<uint64_t>> record_count;
+        // over the whole capacity, draws beyond the records inserted so far are repeated
+        std::unique_ptr<PageDistribution> key_distribution;
+        std::mt19937 generator;
+        std::uniform_real_distribution<> operation_dis;
+        std::uniform_int_distribution<uint64_t> scan_length_dis;
+        std::uniform_int_distribution<int> data_dis;
+        // one page per page a scan can touch, the first one is also used for single records
+        uint64_t buffer_pages;
+        AlignedMemoryBlock page_buffer;
+        std::vector<char> record_buffer;
+        uint64_t operation_counts[YCSB_NUM_OPERATIONS] = {0};
 };
 
 class TableScanWorkload: public Workload {
     public:
         TableScanWorkload() = delete;
-        explicit TableScanWorkload(BufferManager& bm, std::size_t total_workload);
+        explicit TableScanWorkload(BufferManager& bm, std::size_t total_workload, unsigned int queue_depth, unsigned int batch_pages, uint64_t first_page_id);
         void run() final;
+    protected:
+        void begin_measurement() override;
     private:
+        void run_async(char *read_target);
+        void run_batched(char *read_target);
+        void run_pooled(char *read_target);
         BufferManager& bm;
         std::size_t total_workload;
+        unsigned int queue_depth;
+        unsigned int batch_pages;
+        uint64_t first_page_id;
 };
 
 class LoggingWorkload: public Workload {
     public:
         LoggingWorkload() = delete;
-        explicit LoggingWorkload(BufferManager& bm, std::size_t total_workload, std::size_t log_entry_size, uint32_t pattern_seed, bool committing);
+        // the log of this thread is [first_page_id, last_page_id), with the header page first if committing
+        explicit LoggingWorkload(BufferManager& bm, std::size_t total_workload, std::size_t log_entry_size, uint32_t pattern_seed, bool committing, uint64_t first_page_id, uint64_t last_page_id);
         void run() final;
+    protected:
+        void begin_measurement() override;
     private:
         BufferManager& bm;
         std::size_t total_workload;
         std::size_t log_entry_size;
         uint32_t pattern_seed;
         bool committing;
+        uint64_t first_page_id;
+        uint64_t last_page_id;
+        std::mt19937 generator;
         std::mt19937& gen();
         int next_random_data(int max);
 };
@@ -65,12 +211,17 @@ class SimpleLoggingWorkload: public Workload {
         explicit SimpleLoggingWorkload(std::string directory, std::string file_suffix, std::function<AppendableFile*(struct IOWrapperConfig&)> create_appendable_file,  std::size_t total_workload, std::size_t log_entry_size, uint32_t pattern_seed, int page_pool_size, bool log_use_fallocate);
         ~SimpleLoggingWorkload();
         void run() final;
+        std::vector<std::pair<std::string, const LatencyHistogram*>> get_latencies() const override;
+    protected:
+        void begin_measurement() override;
     private:
+        LatencyHistogram append_latency;
         AppendableFile *logfile;
         std::size_t total_workload;
         std::size_t log_entry_size;
         uint32_t pattern_seed;
         int page_pool_size;
+        std::mt19937 generator;
         std::mt19937& gen();
         int next_random_data(int max);
         std::vector<AlignedMemoryBlock> random_page_pool;
@@ -1,10 +1,15 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <cstdint>
 #include <iterator>
 #include <random>
 #include <vector>
 #include <memory>
+#include <numeric>
+#include <thread>
 
 #include <unistd.h>
 #include <sys/wait.h>
@@ -14,16 +19,355 @@
 #include "argh.h"
 #include "util.hpp"
 #include "workload.hpp"
+#include "arrivals.hpp"
 #include "buffer_manager.hpp"
+#include "buffer_pool.hpp"
+#include "distribution.hpp"
+#include "histogram.hpp"
+#include "perf_counters.hpp"
+#include "placement.hpp"
+#include "pmem_tier.hpp"
+#include "report.hpp"
+#include "run_control.hpp"
 #include "iowrapper.hpp"
 
+// merges histograms of the same name, keeping the order they are first reported in
+void merge_latencies(std::vector<std::pair<std::string, LatencyHistogram>>& merged, const std::vector<std::pair<std::string, const LatencyHistogram*>>& latencies) {
+    for (auto& latency : latencies) {
+        auto it = std::find_if(merged.begin(), merged.end(), [&](const auto& m) { return m.first == latency.first; });
+        if (it == merged.end()) {
+            merged.emplace_back(latency.first, LatencyHistogram());
+            it = merged.end() - 1;
+        }
+        it->second.merge(*latency.second);
+    }
+}
+
+// sums up counts of the same name, keeping the order they are first reported in
+void merge_counts(std::vector<std::pair<std::string, uint64_t>>& merged, const std::vector<std::pair<std::string, uint64_t>>& counts) {
+    for (auto& count : counts) {
+        auto it = std::find_if(merged.begin(), merged.end(), [&](const auto& m) { return m.first == count.first; });
+        if (it == merged.end())
+            merged.push_back(count);
+        else
+            it->second += count.second;
+    }
+}
+
+template<typename T>
+void log_option(Report& report, const std::string& name, const T& value) {
+    bmlog::info(name + ": " + report.add("options", name, value));
+}
+
+template<typename T>
+void log_metric(Report& report, const std::string& name, const T& value) {
+    bmlog::info(name + ": " + report.add("metrics", name, value));
+}
+
+// perf_scope is empty if no perf counters should be opened
+void run_workloads(std::vector<std::unique_ptr<Workload>>& workloads, std::vector<std::unique_ptr<BufferManager>>& bms, Report& report, const std::string& perf_scope, const struct RunControlConfig& run_config) {
+    std::vector<std::thread> threads;
+    std::vector<LatencyHistogram> run_latencies(workloads.size());
+    std::vector<std::vector<std::pair<std::string, uint64_t>>> thread_perf_counts(workloads.size());
+    std::unique_ptr<PerfCounters> process_perf;
+    if (perf_scope == "PROCESS") {
+        // opened before the threads exist, so they inherit the counters
+        process_perf = std::make_unique<PerfCounters>(PERF_COUNTERS_PROCESS);
+        process_perf->start();
+    }
+    std::unique_ptr<RunControl> run_control;
+    if (is_controlled(run_config)) {
+        run_control = std::make_unique<RunControl>(run_config);
+        for (auto& wl : workloads) wl->set_run_control(run_control.get());
+    }
+    std::atomic<std::size_t> finished{0};
+    uint64_t start = now_ns();
+    for (std::size_t i = 0; i < workloads.size(); i++) {
+        threads.emplace_back([&workloads, &run_latencies, &thread_perf_counts, &perf_scope, &finished, i]() {
+            std::unique_ptr<PerfCounters> thread_perf;
+            if (perf_scope == "THREAD") thread_perf = std::make_unique<PerfCounters>(PERF_COUNTERS_THREAD);
+            if (thread_perf) thread_perf->start();
+            uint64_t run_start = now_ns();
+            workloads[i]->run();
+            run_latencies[i].record(now_ns() - run_start);
+            if (thread_perf) {
+                thread_perf->stop();
+                thread_perf_counts[i] = thread_perf->get_counts();
+            }
+            finished.fetch_add(1, std::memory_order_release);
+        });
+    }
+    if (run_control) {
+        run_control->monitor([&workloads]() {
+            uint64_t progress = 0;
+            for (auto& wl : workloads) progress += wl->get_progress();
+            return progress;
+        }, [&finished, &workloads]() { return finished.load(std::memory_order_acquire) == workloads.size(); });
+    }
+    for (auto& t : threads) t.join();
+    // only the time after the warm-up counts
+    std::chrono::duration<double> runtime = std::chrono::nanoseconds(now_ns() - (run_control ? run_control->get_measure_start_ns() : start));
+    if (process_perf) process_perf->stop();
+
+    uint64_t processed_data = 0;
+    uint64_t processed_operations = 0;
+    // the perf counters also run during the warm-up, so they are normalized by everything processed
+    uint64_t total_data = 0;
+    uint64_t total_operations = 0;
+    for (auto& wl : workloads) {
+        processed_data += wl->get_processed_data();
+        processed_operations += wl->get_processed_operations();
+        total_data += wl->get_total_data();
+        total_operations += wl->get_total_operations();
+    }
+
+    log_metric(report, "Threads", workloads.size());
+    if (run_control) {
+        log_metric(report, "Warm-up (s)", run_control->get_warmup_time());
+        if (run_config.steady_state) log_metric(report, "Steady State Reached", run_control->reached_steady_state());
+    }
+    log_metric(report, "Runtime (s)", runtime.count());
+    log_metric(report, "Processed Data", processed_data);
+    log_metric(report, "Throughput (MiB/s)", static_cast<double>(processed_data) / (1 << 20) / runtime.count());
+
+    // summed up over all threads, in the order the workload reports them
+    std::vector<std::pair<std::string, uint64_t>> operation_counts;
+    for (auto& wl : workloads) merge_counts(operation_counts, wl->get_operation_counts());
+    for (auto& count : operation_counts) {
+        log_metric(report, count.first + " Operations", count.second);
+        log_metric(report, count.first + " Throughput (ops/s)", count.second / runtime.count());
+    }
+
+    std::vector<std::pair<std::string, LatencyHistogram>> latencies;
+    for (auto& bm : bms) merge_latencies(latencies, bm->get_latencies());
+    for (auto& wl : workloads) merge_latencies(latencies, wl->get_latencies());
+    for (auto& run_latency : run_latencies) merge_latencies(latencies, {{"Workload Run", &run_latency}});
+    for (auto& latency : latencies) {
+        const LatencyHistogram& h = latency.second;
+        if (h.get_count() == 0) continue;
+        std::string name = latency.first;
+        log_metric(report, name + " Operations", h.get_count());
+        log_metric(report, name + " Throughput (ops/s)", h.get_count() / runtime.count());
+        log_metric(report, name + " Latency Mean (ns)", h.get_mean());
+        log_metric(report, name + " Latency p50 (ns)", h.percentile(50));
+        log_metric(report, name + " Latency p90 (ns)", h.percentile(90));
+        log_metric(report, name + " Latency p99 (ns)", h.percentile(99));
+        log_metric(report, name + " Latency p99.9 (ns)", h.percentile(99.9));
+        log_metric(report, name + " Latency Max (ns)", h.get_max());
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> perf_counts;
+    if (process_perf) perf_counts = process_perf->get_counts();
+    for (auto& counts : thread_perf_counts) merge_counts(perf_counts, counts);
+    if (!perf_counts.empty()) log_metric(report, "Processed Operations", processed_operations);
+    for (auto& count : perf_counts) {
+        log_metric(report, "Perf " + count.first, count.second);
+        log_metric(report, "Perf " + count.first + " per Operation", static_cast<double>(count.second) / std::max(total_operations, static_cast<uint64_t>(1)));
+        log_metric(report, "Perf " + count.first + " per Byte", static_cast<double>(count.second) / std::max(total_data, static_cast<uint64_t>(1)));
+    }
+}
+
+// the factories an --ioengine stands for and which of the engine specific options it honors
+struct Engine {
+    std::function<IOWrapper*(struct IOWrapperConfig&)> io_wrapper_factory;
+    std::function<AppendableFile*(struct IOWrapperConfig&)> appendable_file_factory = create_appendable_file<LinuxAppendableFile>;
+    bool has_durability_policy = false;
+    bool has_copy_kernels = false;
+};
+
+struct Engine select_engine(const std::string& ioengine) {
+    struct Engine engine;
+    if (ioengine == "LINUX") {
+        engine.io_wrapper_factory = create_io_wrapper<LinuxIOWrapper>;
+        engine.has_durability_policy = true;
+    } else if (ioengine == "LINUX_DIRECT") {
+        engine.io_wrapper_factory = create_io_wrapper<DirectLinuxIOWrapper>;
+        engine.has_durability_policy = true;
+    } else if (ioengine == "LINUX_PREALLOC") {
+        engine.io_wrapper_factory = create_io_wrapper<LinuxIOWrapper>;
+        engine.has_durability_policy = true;
+        engine.appendable_file_factory = create_appendable_file<LinuxPreallocatedAppendableFile>;
+    } else if (ioengine == "LINUX_PREFAULT") {
+        engine.io_wrapper_factory = create_io_wrapper<LinuxIOWrapper>;
+        engine.has_durability_policy = true;
+        engine.appendable_file_factory = create_appendable_file<LinuxPrefaultedAppendableFile>;
+    } else if (ioengine == "MMAP") {
+        engine.io_wrapper_factory = create_io_wrapper<MmapIOWrapper>;
+        engine.has_copy_kernels = true;
+    } else if (ioengine == "MMAP_CLWB") {
+        engine.io_wrapper_factory = create_io_wrapper<FlushingMmapIOWrapper>;
+        engine.has_copy_kernels = true;
+    } else if (ioengine == "MMAP_EADR") {
+        engine.io_wrapper_factory = create_io_wrapper<EadrMmapIOWrapper>;
+        engine.has_copy_kernels = true;
+    } else if (ioengine == "STD") {
+        engine.io_wrapper_factory = create_io_wrapper<STDIOWrapper>;
+        engine.has_durability_policy = true;
+#ifdef __linux
+    } else if (ioengine == "LIBPMEM2" || ioengine == "LIBPMEM") {
+        engine.io_wrapper_factory = create_io_wrapper<LibPMIOWrapper>;
+        engine.has_copy_kernels = true;
+        engine.appendable_file_factory = create_appendable_file<LibpmemAppendableFile>;
+    } else if (ioengine == "LIBPMEM2_PF" || ioengine == "LIBPMEM_PF") {
+        engine.io_wrapper_factory = create_io_wrapper<LibPMIOWrapper>;
+        engine.has_copy_kernels = true;
+        engine.appendable_file_factory = create_appendable_file<LibpmemPrefaultedAppendableFile>;
+    } else if (ioengine == "IO_URING") {
+        engine.io_wrapper_factory = create_io_wrapper<IoUringIOWrapper>;
+    } else if (ioengine == "IO_URING_DIRECT") {
+        engine.io_wrapper_factory = create_io_wrapper<DirectIoUringIOWrapper>;
+#endif
+    } else if (ioengine == "ASM") {
+        engine.io_wrapper_factory = create_io_wrapper<ASMIOWrapper>;
+    } else if (ioengine == "ASM_CLWB") {
+        engine.io_wrapper_factory = create_io_wrapper<ClwbASMIOWrapper>;
+    } else {
+        crash("Unsupported ioengine!");
+    }
+    return engine;
+}
+
+// the options workloads are created from, besides the buffer manager they run on
+struct WorkloadOptions {
+    std::string workload;
+    std::size_t total_workload;
+    int write_proportion; // int from 0 to 100
+    int random_pages;
+    std::size_t read_target_buffer_size;
+    unsigned int queue_depth;
+    unsigned int batch_pages;
+    std::function<PageDistribution*(uint64_t, const struct DistributionConfig&)> page_distribution_factory;
+    struct DistributionConfig distribution_config;
+    bool pregenerate;
+    std::string op_stream_file;
+    char ycsb_workload;
+    std::size_t record_size;
+    uint64_t max_scan_length;
+    std::size_t log_entry_size;
+    bool committing;
+};
+
+// the workload of one of num_threads threads, logging2 does not run on a buffer manager and is created by main
+std::unique_ptr<Workload> create_workload(const struct WorkloadOptions& options, BufferManager& bm, unsigned int thread_id, unsigned int num_threads, uint32_t pattern_seed, std::shared_ptr<std::atomic<uint64_t>> ycsb_records) {
+    // sequential workloads start in their own part of the buffer
+    uint64_t first_page_id = thread_id * (bm.get_total_num_of_pages() / num_threads);
+    uint64_t last_page_id = thread_id + 1 == num_threads ? bm.get_total_num_of_pages() : first_page_id + bm.get_total_num_of_pages() / num_threads;
+    uint64_t target_pages = std::max(static_cast<std::size_t>(1), options.read_target_buffer_size / bm.get_page_size());
+    if (options.workload == "bufman") {
+        auto wl = std::make_unique<BufferManagementWorkload>(bm, options.total_workload, static_cast<double>(options.write_proportion) / 100.0f, options.random_pages, pattern_seed, target_pages, options.queue_depth, options.page_distribution_factory(bm.get_total_num_of_pages(), options.distribution_config));
+        if (options.pregenerate) {
+            std::string stream_file = num_threads > 1 && !options.op_stream_file.empty() ? options.op_stream_file + "_" + std::to_string(thread_id) : options.op_stream_file;
+            wl->pregenerate_operations(stream_file);
+        }
+        return wl;
+    } else if (options.workload == "ycsb") {
+        return std::make_unique<YcsbWorkload>(bm, options.total_workload, ycsb_mix(options.ycsb_workload), options.record_size, options.max_scan_length, pattern_seed, options.distribution_config, ycsb_records);
+    } else if (options.workload == "tablescan") {
+        return std::make_unique<TableScanWorkload>(bm, options.total_workload, options.queue_depth, options.batch_pages, first_page_id);
+    } else if (options.workload == "logging") {
+        if (options.total_workload < options.log_entry_size) {
+            crash("total workload requested is smaller than one single log entry!");
+        }
+        return std::make_unique<LoggingWorkload>(bm, options.total_workload, options.log_entry_size, pattern_seed, options.committing, first_page_id, last_page_id);
+    }
+    crash("Unsupported workload!");
+    return nullptr;
+}
+
+// open-loop, every thread issues its share of the rate
+void set_arrivals(std::vector<std::unique_ptr<Workload>>& workloads, double rate, ArrivalProcess process, uint32_t seed) {
+    if (rate <= 0) return;
+    for (std::size_t i = 0; i < workloads.size(); i++)
+        workloads[i]->set_arrival_schedule(std::make_unique<ArrivalSchedule>(rate / workloads.size(), process, seed + i));
+}
+
+// the buffer counts as loaded with YCSB records, except for 10% that is left for inserts
+std::shared_ptr<std::atomic<uint64_t>> ycsb_record_count(const struct WorkloadOptions& options, std::size_t page_size, uint64_t total_pages) {
+    uint64_t record_capacity = options.workload == "ycsb" ? (page_size / options.record_size) * total_pages : 0;
+    return std::make_shared<std::atomic<uint64_t>>(record_capacity - record_capacity / 10);
+}
+
+void log_pool_stats(const std::vector<std::unique_ptr<BufferManager>>& bms, Report& report) {
+    BufferPoolStats total{0, 0, 0, 0};
+    for (auto& bm : bms) {
+        const BufferPoolStats& stats = bm->get_pool_stats();
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.evictions += stats.evictions;
+        total.writebacks += stats.writebacks;
+    }
+    uint64_t accesses = std::max(total.hits + total.misses, static_cast<uint64_t>(1));
+    log_metric(report, "Buffer Pool Hits", total.hits);
+    log_metric(report, "Buffer Pool Misses", total.misses);
+    log_metric(report, "Buffer Pool Hit Rate", static_cast<double>(total.hits) / accesses);
+    log_metric(report, "Buffer Pool Evictions", total.evictions);
+    log_metric(report, "Buffer Pool Writebacks", total.writebacks);
+}
+
+void log_tier_stats(const std::vector<std::unique_ptr<BufferManager>>& bms, Report& report) {
+    TierStats total{0, 0, 0, 0, 0};
+    for (auto& bm : bms) {
+        const TierStats& stats = bm->get_tier_stats();
+        total.hits += stats.hits;
+        total.in_place_reads += stats.in_place_reads;
+        total.promotions += stats.promotions;
+        total.demotions += stats.demotions;
+        total.writebacks += stats.writebacks;
+    }
+    log_metric(report, "Tier Hits", total.hits);
+    log_metric(report, "Tier In-Place Reads", total.in_place_reads);
+    log_metric(report, "Tier Promotions", total.promotions);
+    log_metric(report, "Tier Demotions", total.demotions);
+    log_metric(report, "Tier Writebacks", total.writebacks);
+}
+
+// two-sided 95% quantile of Student's t distribution with df degrees of freedom
+double student_t95(uint64_t df) {
+    static const double quantiles[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                       2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df == 0) return 0;
+    if (df <= 30) return quantiles[df - 1];
+    if (df <= 60) return 2.000;
+    if (df <= 120) return 1.980;
+    return 1.960;
+}
+
+// mean, sample standard deviation and half width of the 95% confidence interval of every metric
+// over the repetitions of a sweep point
+void log_sweep_metrics(Report& report, const std::vector<std::pair<std::string, std::vector<double>>>& samples) {
+    for (auto& metric : samples) {
+        const std::vector<double>& values = metric.second;
+        double n = static_cast<double>(values.size());
+        double mean = std::accumulate(values.begin(), values.end(), 0.0) / n;
+        double squares = 0;
+        for (double v : values) squares += (v - mean) * (v - mean);
+        double stddev = values.size() > 1 ? std::sqrt(squares / (n - 1)) : 0;
+        log_metric(report, metric.first + " Mean", mean);
+        log_metric(report, metric.first + " Stddev", stddev);
+        log_metric(report, metric.first + " CI95", student_t95(values.size() - 1) * stddev / std::sqrt(n));
+    }
+}
+
+// CSV results get a row per sweep point, JSON results a file per point
+std::string sweep_output_file(const std::string& output_file, uint64_t point) {
+    std::string extension = ".csv";
+    if (output_file.size() >= extension.size() && output_file.compare(output_file.size() - extension.size(), extension.size(), extension) == 0)
+        return output_file;
+    std::size_t dot = output_file.rfind('.');
+    std::size_t slash = output_file.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return output_file + "_" + std::to_string(point);
+    return output_file.substr(0, dot) + "_" + std::to_string(point) + output_file.substr(dot);
+}
+
 int main(int argc, char *argv[]) {
     // setup logging IO
     prepare_logging();
 
     // argument parsing
     argh::parser cmdl;
-    cmdl.add_params({"-l", "--workload", "-i", "--ioengine", "-b", "--buffersize", "-s", "--suffix", "-p", "--pagesize", "-w", "--write", "-t", "--total", "--randompages", "--le", "--rtbs", "--read-target-buffer-size"});
+    cmdl.add_params({"-l", "--workload", "-i", "--ioengine", "-b", "--buffersize", "-s", "--suffix", "-p", "--pagesize", "-w", "--write", "-t", "--total", "--randompages", "--le", "--rtbs", "--read-target-buffer-size", "--qd", "--iodepth", "--threads", "--pool-size", "--eviction", "--distribution", "--zipf-theta", "--hot-set", "--hot-ops", "--seq-run", "--ycsb", "--record-size", "--max-scan", "--op-stream", "-o", "--output", "--perf", "--durability", "--sync-every", "--sync-interval", "--read-kernel", "--write-kernel", "--sweep-ioengines", "--sweep-pagesizes", "--sweep-writes", "--sweep-threads", "--sweep-workloads", "--repetitions", "--duration", "--warmup", "--steady-window", "--steady-windows", "--steady-cov", "--max-warmup", "--rate", "--arrivals", "--batch", "--placement", "--stripe-pages", "--placement-weights", "--mount", "--tier", "--tier-engine", "--tier-size", "--promote-after"});
     cmdl.parse(argc, argv);
 
     std::size_t page_size; // B
@@ -33,7 +377,21 @@ int main(int argc, char *argv[]) {
     cmdl({"-b", "--buffersize"}, 1) >> buffer_size;
     buffer_size <<= 30; // now its in B
     std::size_t full_buffer_size_argument = buffer_size;
-    buffer_size /= std::distance(cmdl.pos_args().begin() + 1, cmdl.pos_args().end());
+
+    // instead of the positional directories, --mount DIR:ENGINE[:OPTION,...] can be given once per
+    // mount to access it with its own engine. argh only keeps the first value of a parameter.
+    std::vector<std::string> mount_args;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mount" && i + 1 < argc) mount_args.push_back(argv[++i]);
+        else if (arg.rfind("--mount=", 0) == 0) mount_args.push_back(arg.substr(8));
+    }
+    std::size_t num_positional_mounts = std::distance(cmdl.pos_args().begin() + 1, cmdl.pos_args().end());
+    if (!mount_args.empty() && num_positional_mounts > 0)
+        crash("give the mounts either as directories or with --mount");
+    if (mount_args.empty() && num_positional_mounts == 0)
+        crash("no mounts given");
+    buffer_size /= mount_args.empty() ? num_positional_mounts : mount_args.size();
 
     std::string buffer_file_suffix;
     cmdl({"-s", "--suffix"}) >> buffer_file_suffix;
@@ -55,6 +413,8 @@ int main(int argc, char *argv[]) {
 
     int random_pages;
     cmdl({"--randompages"}, 5) >> random_pages;
+    if (random_pages < 1)
+        crash("the random page pool needs at least one page");
     
     bool initialize = false;
     if (cmdl[{"--initialize"}]) initialize = true;
@@ -99,33 +459,321 @@ int main(int argc, char *argv[]) {
     bool madv_sequential = false;
     if (cmdl[{"--madv-sequential"}]) madv_sequential = true;
 
+    unsigned int num_threads;
+    cmdl({"--threads"}, 1) >> num_threads;
+    if (num_threads < 1)
+        crash("invalid number of threads " + std::to_string(num_threads));
+
+    std::size_t pool_size; // MiB, 0 disables the buffer pool
+    cmdl({"--pool-size"}, 0) >> pool_size;
+    pool_size <<= 20;
+    std::size_t pool_frames = pool_size / page_size;
+
+    std::string eviction;
+    cmdl({"--eviction"}, "CLOCK") >> eviction;
+
+    // PMem tier between the buffer pool and the buffer files, its file is named like a buffer file
+    std::string tier_dir;
+    cmdl({"--tier"}, "") >> tier_dir;
+    std::string tier_engine_name;
+    cmdl({"--tier-engine"}, "LIBPMEM2") >> tier_engine_name;
+    std::size_t tier_size; // MiB, 0 uses the whole tier file
+    cmdl({"--tier-size"}, 0) >> tier_size;
+    tier_size <<= 20;
+    struct TierConfig tier_config{2, false};
+    cmdl({"--promote-after"}, 2) >> tier_config.promote_after; // accesses
+    if (cmdl[{"--tier-in-place"}]) tier_config.read_in_place = true; // serve reads of tier pages from the tier
+    if (!tier_dir.empty() && pool_size == 0)
+        crash("the PMem tier needs a buffer pool in front of it");
+
+    std::string distribution;
+    cmdl({"--distribution"}, "UNIFORM") >> distribution;
+
+    // how the pages are spread over the mounts
+    std::string placement;
+    cmdl({"--placement"}, "STRIPE") >> placement; // STRIPE, RANGE, HASH or WEIGHTED
+    struct PlacementConfig placement_config{1, {}};
+    cmdl({"--stripe-pages"}, 1) >> placement_config.stripe_pages; // pages per stripe unit
+    std::string placement_weight_list;
+    // per mount. If not given, the bandwidth of every mount is measured: 1 MiB sequential reads of the
+    // first 256 MiB of its buffer file with O_DIRECT, --qd of them in flight
+    cmdl({"--placement-weights"}, "") >> placement_weight_list;
+    for (auto& value : split_list(placement_weight_list)) placement_config.weights.push_back(std::stod(value));
+    if (placement_config.stripe_pages < 1)
+        crash("invalid stripe unit " + std::to_string(placement_config.stripe_pages));
+
+    struct DistributionConfig distribution_config;
+    cmdl({"--zipf-theta"}, 0.99) >> distribution_config.zipf_theta;
+    int hot_set; // int from 0 to 100, share of the pages
+    cmdl({"--hot-set"}, 20) >> hot_set;
+    int hot_ops; // int from 0 to 100, share of the accesses
+    cmdl({"--hot-ops"}, 80) >> hot_ops;
+    distribution_config.hot_fraction = hot_set / 100.0;
+    distribution_config.hot_operations = hot_ops / 100.0;
+    cmdl({"--seq-run"}, 64) >> distribution_config.sequential_run;
+
+    // pregenerate the bufman operations instead of drawing them in the timed loop
+    bool pregenerate = false;
+    if (cmdl[{"--pregenerate"}]) pregenerate = true;
+
+    // replay the operations from this file, or save them there if it does not exist
+    std::string op_stream_file;
+    cmdl({"--op-stream"}, "") >> op_stream_file;
+    if (!op_stream_file.empty()) pregenerate = true;
+
+    // timing every pagein/pageout costs two clock reads per operation
+    bool track_latency = true;
+    if (cmdl[{"--no-latency"}]) track_latency = false;
+
+    std::string ycsb_workload;
+    cmdl({"--ycsb"}, "A") >> ycsb_workload;
+    if (_workload == "ycsb" && ycsb_workload.size() != 1)
+        crash("invalid YCSB workload " + ycsb_workload);
+
+    std::size_t record_size; // B
+    cmdl({"--record-size"}, 1000) >> record_size;
+    if (_workload == "ycsb" && (record_size == 0 || record_size > page_size))
+        crash("YCSB records have to fit into a page");
+
+    uint64_t max_scan_length; // records
+    cmdl({"--max-scan"}, 100) >> max_scan_length;
+
+    bool uring_sqpoll = false;
+    if (cmdl[{"--uring-sqpoll"}]) uring_sqpoll = true;
+
+    // when the LINUX and STD engines make pageouts durable
+    std::string durability;
+    cmdl({"--durability"}, "FDATASYNC") >> durability;
+    struct DurabilityConfig durability_config{DURABILITY_FDATASYNC, 1, 0};
+    cmdl({"--sync-every"}, 64) >> durability_config.sync_every; // pageouts per window/group, batched pageouts count one by one
+    cmdl({"--sync-interval"}, 0) >> durability_config.sync_interval_us; // us, 0 only syncs by count
+    if (durability_config.sync_every == 0)
+        crash("sync groups need at least one pageout");
+
+    // how the MMAP* and LIBPMEM* engines copy between a frame and the mapping (see copy_kernels.hpp),
+    // libpmem2 writes additionally take PMEM2, PMEM2_NONTEMPORAL, PMEM2_TEMPORAL and PMEM2_WC
+    std::string read_kernel, write_kernel;
+    cmdl({"--read-kernel"}, "MEMCPY") >> read_kernel;
+    cmdl({"--write-kernel"}, "DEFAULT") >> write_kernel; // MEMCPY for mmap, PMEM2 for libpmem2
+    if (write_kernel == "DEFAULT") write_kernel = "";
+
+    unsigned int queue_depth; // requests in flight per workload
+    cmdl({"--qd", "--iodepth"}, 1) >> queue_depth;
+    if (queue_depth < 1)
+        crash("invalid queue depth " + std::to_string(queue_depth));
+
+    unsigned int batch_pages; // pages the table scan reads with one batch
+    cmdl({"--batch"}, 1) >> batch_pages;
+    if (batch_pages < 1)
+        crash("invalid batch size " + std::to_string(batch_pages));
+    if (batch_pages > 1 && queue_depth > 1)
+        crash("batches are synchronous, use either --batch or --qd");
+
     std::vector<std::string> directories;
     std::copy(cmdl.pos_args().begin() + 1, cmdl.pos_args().end(), std::back_inserter(directories));
-    if (cmdl.pos_args().begin() + 1 == cmdl.pos_args().end()) {
-        crash("no mounts given");
+    // directory, engine and options of every --mount
+    std::vector<std::vector<std::string>> mount_fields;
+    for (auto& arg : mount_args) {
+        std::vector<std::string> fields;
+        std::size_t start = 0, end;
+        while ((end = arg.find(':', start)) != std::string::npos) {
+            fields.push_back(arg.substr(start, end - start));
+            start = end + 1;
+        }
+        fields.push_back(arg.substr(start));
+        if (fields.size() < 2 || fields.size() > 3 || fields[0].empty())
+            crash("invalid mount " + arg + ", expected DIR:ENGINE[:OPTION,...]");
+        directories.push_back(fields[0]);
+        mount_fields.push_back(fields);
+    }
+    // logging2 does not run on the buffer manager, it uses the engine of the first mount
+    if (!mount_fields.empty()) {
+        if (cmdl.params().count("sweep-ioengines")) crash("the engines of --mount cannot be swept");
+        ioengine = mount_fields[0][1];
     }
 
     bool committing = false;
     if (cmdl({"--committing"})) committing = true;
 
+    // hardware and software counters around the workload runs, per THREAD or for the whole PROCESS
+    std::string perf_scope;
+    cmdl({"--perf"}, "") >> perf_scope;
+    if (!perf_scope.empty() && perf_scope != "THREAD" && perf_scope != "PROCESS")
+        crash("invalid perf counter scope " + perf_scope);
+
+    // JSON with run metadata, or a CSV row if the name ends with .csv
+    std::string output_file;
+    cmdl({"-o", "--output"}, "") >> output_file;
+
+    // time-bounded runs and warm-up, only operations after the warm-up are counted
+    struct RunControlConfig run_config{0, 0, false, 0, 0, 0, 0};
+    cmdl({"--duration"}, 0) >> run_config.duration; // s, 0 runs until --total is processed after the warm-up
+    cmdl({"--warmup"}, 0) >> run_config.warmup; // s
+    if (cmdl[{"--steady-state"}]) run_config.steady_state = true; // warm up until the throughput is stable
+    uint64_t steady_window; // ms
+    cmdl({"--steady-window"}, 500) >> steady_window;
+    run_config.window = steady_window / 1000.0;
+    cmdl({"--steady-windows"}, 5) >> run_config.windows; // windows the throughput has to be stable over
+    double steady_cov; // %, coefficient of variation of the window throughputs
+    cmdl({"--steady-cov"}, 5) >> steady_cov;
+    run_config.max_variation = steady_cov / 100;
+    cmdl({"--max-warmup"}, 60) >> run_config.max_warmup; // s, measure anyway once the warm-up took this long
+    if (run_config.duration < 0 || run_config.warmup < 0)
+        crash("invalid duration or warm-up");
+
+    // runs the grid of the --sweep-* lists in one process, every list defaults to its single-run option.
+    // Each point is repeated --repetitions times, its metrics are reported as mean, stddev and 95% CI.
+    bool sweep = false;
+    if (cmdl[{"--sweep"}]) sweep = true;
+    std::string sweep_ioengine_list, sweep_page_size_list, sweep_write_list, sweep_thread_list, sweep_workload_list;
+    cmdl({"--sweep-ioengines"}, ioengine) >> sweep_ioengine_list;
+    cmdl({"--sweep-pagesizes"}, std::to_string(page_size)) >> sweep_page_size_list;
+    cmdl({"--sweep-writes"}, std::to_string(write_proportion)) >> sweep_write_list;
+    cmdl({"--sweep-threads"}, std::to_string(num_threads)) >> sweep_thread_list;
+    cmdl({"--sweep-workloads"}, _workload) >> sweep_workload_list;
+    unsigned int repetitions;
+    cmdl({"--repetitions"}, 5) >> repetitions;
+    std::vector<std::string> sweep_ioengines = split_list(sweep_ioengine_list);
+    std::vector<std::string> sweep_workloads = split_list(sweep_workload_list);
+    std::vector<std::size_t> sweep_page_sizes;
+    for (auto& value : split_list(sweep_page_size_list)) sweep_page_sizes.push_back(std::stoull(value));
+    std::vector<int> sweep_write_proportions;
+    for (auto& value : split_list(sweep_write_list)) sweep_write_proportions.push_back(std::stoi(value));
+    std::vector<unsigned int> sweep_threads;
+    for (auto& value : split_list(sweep_thread_list)) sweep_threads.push_back(static_cast<unsigned int>(std::stoul(value)));
+    if (sweep) {
+        if (repetitions < 1)
+            crash("sweeps need at least one repetition");
+        if (sweep_ioengines.empty() || sweep_workloads.empty() || sweep_page_sizes.empty() || sweep_write_proportions.empty() || sweep_threads.empty())
+            crash("empty sweep list");
+        // fail before the first point runs
+        for (auto& e : sweep_ioengines) select_engine(e);
+        for (auto& w : sweep_workloads) {
+            if (w == "logging2") crash("logging2 does not run on the buffer manager and cannot be swept");
+            if (w == "ycsb" && ycsb_workload.size() != 1) crash("invalid YCSB workload " + ycsb_workload);
+            if (w == "ycsb" && std::any_of(sweep_page_sizes.begin(), sweep_page_sizes.end(), [&](std::size_t p) { return record_size > p; }))
+                crash("YCSB records have to fit into a page");
+        }
+        for (std::size_t p : sweep_page_sizes) {
+            if (p == 0 || buffer_size / p == 0) crash("invalid sweep page size " + std::to_string(p));
+            if (pool_size > 0 && pool_size / p == 0) crash("buffer pool is smaller than a single page!");
+        }
+        for (int w : sweep_write_proportions)
+            if (w < 0 || w > 100) crash("invalid write proportion " + std::to_string(w));
+        for (unsigned int t : sweep_threads)
+            if (t < 1) crash("invalid number of threads " + std::to_string(t));
+    }
+
+    // open-loop runs issue --rate operations per second over all threads, evenly spaced or as a Poisson
+    // process. Latencies are then also measured from when an operation should have started.
+    double rate;
+    cmdl({"--rate"}, 0) >> rate; // ops/s, 0 issues every operation as soon as the previous one returned
+    std::string arrivals;
+    cmdl({"--arrivals"}, "POISSON") >> arrivals;
+    ArrivalProcess arrival_process = ARRIVALS_POISSON;
+    if (arrivals == "CONSTANT") {
+        arrival_process = ARRIVALS_CONSTANT;
+    } else if (arrivals != "POISSON") {
+        crash("Unsupported arrival process!");
+    }
+    if (rate < 0)
+        crash("invalid arrival rate");
+    if (rate > 0) {
+        for (auto& w : sweep ? sweep_workloads : std::vector<std::string>{_workload}) {
+            if (w == "tablescan") crash("the table scan cannot run open-loop");
+            if (w == "bufman" && queue_depth > 1 && pool_size == 0) crash("open-loop runs issue one operation at a time, use a queue depth of 1");
+        }
+    }
+
     bmlog::info("Starting up benchmark");
 
-    bmlog::info(std::string("Workload: ") + _workload);
-    bmlog::info(std::string("File Suffix: ") + buffer_file_suffix);
-    bmlog::info(std::string("Pagesize: ") + std::to_string(page_size));
-    bmlog::info(std::string("Buffersize on Disk: ") + std::to_string(buffer_size));
-    bmlog::info(std::string("Pages per buffer: ") + std::to_string(pages_per_buffer));
-    bmlog::info(std::string("Ioengine: " + ioengine));
-    bmlog::info(std::string("Write Proportion: " + std::to_string(write_proportion)));
-    bmlog::info(std::string("Total Workload: " + std::to_string(total_workload)));
-    bmlog::info(std::string("Random Page Poolsize: " + std::to_string(random_pages)));
-    bmlog::info(std::string("Read Target Pages: 0" + std::to_string(target_pages)));
-    bmlog::info(std::string("Using map_sync for mmap: " + std::to_string(mmap_use_map_sync)));
-    bmlog::info(std::string("FADV Random: " + std::to_string(fadv_random)));
-    bmlog::info(std::string("FADV Sequential: " + std::to_string(fadv_sequential)));
-    bmlog::info(std::string("MADV Random: " + std::to_string(madv_random)));
-    bmlog::info(std::string("MADV Sequential: " + std::to_string(madv_sequential)));
-    if (use_fadvise_dontneed) bmlog::info(std::string("fadvise_dontneed: enabled"));
+    Report report;
+    log_option(report, "Workload", _workload);
+    log_option(report, "File Suffix", buffer_file_suffix);
+    log_option(report, "Pagesize", page_size);
+    log_option(report, "Buffersize on Disk", buffer_size);
+    log_option(report, "Pages per buffer", pages_per_buffer);
+    log_option(report, "Ioengine", mount_args.empty() ? ioengine : "PER MOUNT");
+    for (std::size_t i = 0; i < mount_args.size(); i++) log_option(report, "Mount " + std::to_string(i), mount_args[i]);
+    if (ioengine == "ASM" || ioengine == "ASM_CLWB") log_option(report, "ASM ISA", ASMIOWrapper::get_isa());
+    if (ioengine == "MMAP_CLWB") log_option(report, "Flush Instruction", flush_instruction_name(detect_flush_instruction()));
+    log_option(report, "Write Proportion", write_proportion);
+    log_option(report, "Total Workload", total_workload);
+    log_option(report, "Random Page Poolsize", random_pages);
+    if (_workload == "ycsb") {
+        log_option(report, "YCSB Workload", ycsb_workload);
+        log_option(report, "YCSB Record Size", record_size);
+        log_option(report, "YCSB Max Scan Length", max_scan_length);
+    }
+    if (_workload == "logging" || _workload == "logging2") {
+        log_option(report, "Log Entry Size", log_entry_size);
+        log_option(report, "Committing", committing);
+        log_option(report, "Logging Fallocate", log_use_fallocate);
+    }
+    log_option(report, "Placement", placement);
+    if (placement == "STRIPE" || placement == "WEIGHTED") log_option(report, "Stripe Pages", placement_config.stripe_pages);
+    if (placement == "WEIGHTED") log_option(report, "Placement Weights", placement_weight_list.empty() ? "MEASURED" : placement_weight_list);
+    log_option(report, "Page Distribution", distribution);
+    log_option(report, "Pregenerated Operations", pregenerate);
+    log_option(report, "Latency Tracking", track_latency);
+    log_option(report, "Durability", durability);
+    if (durability == "SYNC_FILE_RANGE" || durability == "GROUP") {
+        log_option(report, "Sync Every (pageouts)", durability_config.sync_every);
+        log_option(report, "Sync Interval (us)", durability_config.sync_interval_us);
+    }
+    log_option(report, "Read Kernel", read_kernel);
+    log_option(report, "Write Kernel", write_kernel.empty() ? "DEFAULT" : write_kernel);
+    if (run_config.duration > 0) log_option(report, "Duration (s)", run_config.duration);
+    log_option(report, "Warm-up (s)", run_config.warmup);
+    log_option(report, "Steady State Detection", run_config.steady_state);
+    if (run_config.steady_state) {
+        log_option(report, "Steady State Window (ms)", steady_window);
+        log_option(report, "Steady State Windows", run_config.windows);
+        log_option(report, "Steady State CoV (%)", steady_cov);
+        log_option(report, "Max Warm-up (s)", run_config.max_warmup);
+    }
+    if (rate > 0) {
+        log_option(report, "Target Rate (ops/s)", rate);
+        log_option(report, "Arrivals", arrivals);
+    }
+    log_option(report, "Perf Counters", perf_scope.empty() ? "OFF" : perf_scope);
+    if (!op_stream_file.empty()) log_option(report, "Operation Stream", op_stream_file);
+    if (distribution == "ZIPFIAN" || distribution == "SCRAMBLED_ZIPFIAN" || distribution == "LATEST")
+        log_option(report, "Zipf Theta", distribution_config.zipf_theta);
+    if (distribution == "HOTSET") {
+        log_option(report, "Hot Set Pages (%)", hot_set);
+        log_option(report, "Hot Set Accesses (%)", hot_ops);
+    }
+    if (distribution == "SEQUENTIAL")
+        log_option(report, "Sequential Run", distribution_config.sequential_run);
+    log_option(report, "Read Target Pages", target_pages);
+    log_option(report, "Using map_sync for mmap", mmap_use_map_sync);
+    log_option(report, "MMAP Populate", mmap_populate);
+    log_option(report, "PMem Cacheline Granularity", pmem_use_cacheline_granularity);
+    log_option(report, "FADV Random", fadv_random);
+    log_option(report, "FADV Sequential", fadv_sequential);
+    log_option(report, "FADV Dontneed", use_fadvise_dontneed);
+    log_option(report, "MADV Random", madv_random);
+    log_option(report, "MADV Sequential", madv_sequential);
+    log_option(report, "io_uring SQPOLL", uring_sqpoll);
+    log_option(report, "Queue Depth", queue_depth);
+    if (_workload == "tablescan") log_option(report, "Batch Pages", batch_pages);
+    log_option(report, "Threads", num_threads);
+    log_option(report, "Buffer Pool Size", pool_size);
+    if (pool_size > 0) log_option(report, "Eviction Policy", eviction);
+    log_option(report, "PMem Tier", tier_dir);
+    if (!tier_dir.empty()) {
+        log_option(report, "Tier Engine", tier_engine_name);
+        log_option(report, "Tier Size", tier_size);
+        log_option(report, "Promote After", tier_config.promote_after);
+        log_option(report, "Tier In Place", tier_config.read_in_place);
+    }
+    log_option(report, "Initialize", initialize);
+    log_option(report, "Scramble", scramble);
+    log_option(report, "Sweep", sweep);
+    std::string mount_list;
+    for (auto& dir : directories) mount_list += (mount_list.empty() ? "" : " ") + dir;
+    report.add("options", "Mounts", mount_list);
 
     if (initialize) {
         bmlog::info("We initialize instead of benchmark.");
@@ -140,65 +788,259 @@ int main(int argc, char *argv[]) {
 
     bmlog::info("");
     
-    std::function<IOWrapper*(struct IOWrapperConfig&)> io_wrapper_factory;
-    std::function<AppendableFile*(struct IOWrapperConfig&)> appendable_file_factory = create_appendable_file<LinuxAppendableFile>;
+    struct Engine engine = select_engine(ioengine);
 
-    if (ioengine == "LINUX") {
-        io_wrapper_factory = create_io_wrapper<LinuxIOWrapper>;
-    } else if (ioengine == "LINUX_DIRECT") {
-        io_wrapper_factory = create_io_wrapper<DirectLinuxIOWrapper>;
-    } else if (ioengine == "LINUX_PREALLOC") {
-        io_wrapper_factory = create_io_wrapper<LinuxIOWrapper>;
-        appendable_file_factory = create_appendable_file<LinuxPreallocatedAppendableFile>;
-    } else if (ioengine == "LINUX_PREFAULT") {
-        io_wrapper_factory = create_io_wrapper<LinuxIOWrapper>;
-        appendable_file_factory = create_appendable_file<LinuxPrefaultedAppendableFile>;
-    } else if (ioengine == "MMAP") {
-        io_wrapper_factory = create_io_wrapper<MmapIOWrapper>;
-    } else if (ioengine == "STD") {
-        io_wrapper_factory = create_io_wrapper<STDIOWrapper>;
-#ifdef __linux
-    } else if (ioengine == "LIBPMEM2" || ioengine == "LIBPMEM") {
-        io_wrapper_factory = create_io_wrapper<LibPMIOWrapper>;
-        appendable_file_factory = create_appendable_file<LibpmemAppendableFile>;
-    } else if (ioengine == "LIBPMEM2_PF" || ioengine == "LIBPMEM_PF") {
-        io_wrapper_factory = create_io_wrapper<LibPMIOWrapper>;
-        appendable_file_factory = create_appendable_file<LibpmemPrefaultedAppendableFile>;
-#endif
-    } else if (ioengine == "ASM") {
-        io_wrapper_factory = create_io_wrapper<ASMIOWrapper>;
+    if (durability == "NONE") {
+        durability_config.mode = DURABILITY_NONE;
+    } else if (durability == "FDATASYNC") {
+        durability_config.mode = DURABILITY_FDATASYNC;
+    } else if (durability == "O_DSYNC") {
+        durability_config.mode = DURABILITY_O_DSYNC;
+    } else if (durability == "RWF_DSYNC") {
+        durability_config.mode = DURABILITY_RWF_DSYNC;
+    } else if (durability == "SYNC_FILE_RANGE") {
+        durability_config.mode = DURABILITY_SYNC_FILE_RANGE;
+    } else if (durability == "GROUP") {
+        durability_config.mode = DURABILITY_GROUP;
     } else {
-        crash("Unsupported ioengine!");
+        crash("Unsupported durability policy!");
+    }
+    // with --mount, every mount gets its own engine and options on top of the global ones
+    std::vector<struct Mount> mounts;
+    for (auto& fields : mount_fields) {
+        struct Engine mount_engine = select_engine(fields[1]);
+        struct Mount mount{fields[0], mount_engine.io_wrapper_factory, {nullptr, buffer_file_suffix.c_str(), use_fadvise_dontneed, pmem_use_cacheline_granularity, mmap_use_map_sync, 0, fadv_random, fadv_sequential, madv_random, madv_sequential, mmap_populate, uring_sqpoll, queue_depth, durability_config, read_kernel.c_str(), write_kernel.c_str()}};
+        for (auto& option : split_list(fields.size() > 2 ? fields[2] : "")) {
+            if (option == "mapsync") {
+                mount.config.use_map_sync = true;
+            } else if (option == "mmap-populate") {
+                mount.config.mmap_populate = true;
+            } else if (option == "pmcl") {
+                mount.config.pmem_use_cacheline_granularity = true;
+            } else if (option == "dontneed") {
+                mount.config.use_fadvise = true;
+            } else if (option == "fadv-random") {
+                mount.config.fadv_random = true;
+            } else if (option == "fadv-sequential") {
+                mount.config.fadv_sequential = true;
+            } else if (option == "madv-random") {
+                mount.config.madv_random = true;
+            } else if (option == "madv-sequential") {
+                mount.config.madv_sequential = true;
+            } else if (option == "uring-sqpoll") {
+                mount.config.uring_sqpoll = true;
+            } else {
+                crash("Unsupported mount option " + option + "!");
+            }
+        }
+        engine.has_durability_policy |= mount_engine.has_durability_policy;
+        engine.has_copy_kernels |= mount_engine.has_copy_kernels;
+        if (write_kernel.rfind("PMEM2", 0) == 0 && fields[1].rfind("LIBPMEM", 0) != 0)
+            crash("the " + write_kernel + " write kernel needs a LIBPMEM engine on every mount");
+        mounts.push_back(mount);
+    }
+
+    if (durability != "FDATASYNC" && !engine.has_durability_policy)
+        bmlog::warning("only the LINUX and STD engines have durability policies, ignoring it");
+    if ((read_kernel != "MEMCPY" || !write_kernel.empty()) && !engine.has_copy_kernels)
+        bmlog::warning("only the MMAP and LIBPMEM engines have copy kernels, ignoring them");
+    if (write_kernel.rfind("PMEM2", 0) == 0 && ioengine.rfind("LIBPMEM", 0) != 0)
+        crash("the " + write_kernel + " write kernel needs a LIBPMEM engine");
+
+    std::function<EvictionPolicy*(std::size_t)> eviction_policy_factory;
+    if (eviction == "CLOCK") {
+        eviction_policy_factory = create_eviction_policy<ClockEvictionPolicy>;
+    } else if (eviction == "LRU2") {
+        eviction_policy_factory = create_eviction_policy<LRU2EvictionPolicy>;
+    } else if (eviction == "2Q") {
+        eviction_policy_factory = create_eviction_policy<TwoQEvictionPolicy>;
+    } else {
+        crash("Unsupported eviction policy!");
+    }
+
+    // the tier is shared by all threads and has a single wrapper, only the mapping engines can be called concurrently
+    struct Engine tier_engine = select_engine(tier_engine_name);
+    if (!tier_dir.empty() && !tier_engine.has_copy_kernels)
+        crash("the PMem tier needs one of the MMAP or LIBPMEM engines");
+    auto create_tier = [&](std::size_t tier_page_size, uint64_t num_pages) {
+        struct IOWrapperConfig tier_wrapper_config{tier_dir.c_str(), buffer_file_suffix.c_str(), false, pmem_use_cacheline_granularity, mmap_use_map_sync, 0, false, false, madv_random, madv_sequential, mmap_populate, false, 1, durability_config, read_kernel.c_str(), write_kernel.c_str()};
+        IOWrapper *tier_wrapper = tier_engine.io_wrapper_factory(tier_wrapper_config);
+        std::size_t num_slots = (tier_size > 0 ? tier_size : tier_wrapper->get_filesize()) / tier_page_size;
+        return std::make_shared<PMemTier>(tier_wrapper, num_slots, tier_page_size, num_pages, directories.size(), tier_config);
+    };
+
+    std::function<PagePlacement*(std::size_t, uint64_t, const struct PlacementConfig&)> placement_factory;
+    if (placement == "STRIPE") {
+        placement_factory = create_page_placement<StripedPlacement>;
+    } else if (placement == "RANGE") {
+        placement_factory = create_page_placement<RangePlacement>;
+    } else if (placement == "HASH") {
+        placement_factory = create_page_placement<HashPlacement>;
+    } else if (placement == "WEIGHTED") {
+        placement_factory = create_page_placement<WeightedPlacement>;
+    } else {
+        crash("Unsupported placement policy!");
     }
+    if (!placement_config.weights.empty() && placement != "WEIGHTED")
+        bmlog::warning("only the WEIGHTED placement has weights, ignoring them");
+    // without --placement-weights, the first buffer manager of an engine measures them
+    std::vector<double> placement_weights = placement_config.weights;
 
-    if (!initialize && !scramble) {
-        std::unique_ptr<Workload> wl;
-        if (_workload != "logging2") {
-            BufferManager bm(directories, buffer_file_suffix.c_str(), page_size, pages_per_buffer, use_fadvise_dontneed, pmem_use_cacheline_granularity, mmap_use_map_sync, io_wrapper_factory, fadv_random, fadv_sequential, madv_random, madv_sequential, mmap_populate);
-            if (_workload == "bufman") {
-                wl = std::make_unique<BufferManagementWorkload>(bm, total_workload, static_cast<double>(write_proportion) / 100.0f, random_pages, suffix_to_seed(buffer_file_suffix), target_pages);
-            } else if (_workload == "tablescan") {
-                wl = std::make_unique<TableScanWorkload>(bm, total_workload);
-            } else if (_workload == "logging") {
-                if (total_workload < log_entry_size) {
-                    crash("total workload requested is smaller than one single log entry!");
+    std::function<PageDistribution*(uint64_t, const struct DistributionConfig&)> page_distribution_factory;
+    if (distribution == "UNIFORM") {
+        page_distribution_factory = create_page_distribution<UniformDistribution>;
+    } else if (distribution == "ZIPFIAN") {
+        page_distribution_factory = create_page_distribution<ZipfianDistribution>;
+    } else if (distribution == "SCRAMBLED_ZIPFIAN") {
+        page_distribution_factory = create_page_distribution<ScrambledZipfianDistribution>;
+    } else if (distribution == "LATEST") {
+        page_distribution_factory = create_page_distribution<LatestDistribution>;
+    } else if (distribution == "HOTSET") {
+        page_distribution_factory = create_page_distribution<HotSetDistribution>;
+    } else if (distribution == "SEQUENTIAL") {
+        page_distribution_factory = create_page_distribution<SequentialDistribution>;
+    } else {
+        crash("Unsupported page distribution!");
+    }
+
+    if (pool_size > 0 && pool_frames == 0)
+        crash("buffer pool is smaller than a single page!");
+    if (pool_size > 0 && queue_depth > 1)
+        bmlog::warning("the buffer pool loads pages synchronously, ignoring the queue depth");
+    if (pool_size > 0 && batch_pages > 1)
+        bmlog::warning("the buffer pool loads pages one at a time, ignoring the batch size");
+
+    struct WorkloadOptions workload_options{_workload, total_workload, write_proportion, random_pages, read_target_buffer_size, queue_depth, batch_pages, page_distribution_factory,
+        distribution_config, pregenerate, op_stream_file, ycsb_workload[0], record_size, max_scan_length, log_entry_size, committing};
+
+    // every thread gets its own buffer manager (and thus own file descriptors/mappings)
+    auto create_buffer_manager = [&](const struct Engine& bm_engine, std::size_t bm_page_size) {
+        auto bm = !mounts.empty() ? std::make_unique<BufferManager>(mounts, bm_page_size, buffer_size / bm_page_size) : std::make_unique<BufferManager>(directories, buffer_file_suffix.c_str(), bm_page_size, buffer_size / bm_page_size, use_fadvise_dontneed, pmem_use_cacheline_granularity, mmap_use_map_sync, bm_engine.io_wrapper_factory, fadv_random, fadv_sequential, madv_random, madv_sequential, mmap_populate, uring_sqpoll, queue_depth, durability_config, read_kernel.c_str(), write_kernel.c_str());
+        bm->set_latency_tracking(track_latency);
+        if (placement == "WEIGHTED" && placement_config.weights.empty()) {
+            placement_config.weights = bm->measure_bandwidth(queue_depth);
+            std::string measured;
+            for (double w : placement_config.weights) measured += (measured.empty() ? "" : ",") + std::to_string(w);
+            bmlog::info("measured mount bandwidths (MiB/s): " + measured);
+        }
+        bm->set_placement(placement_factory, placement_config);
+        return bm;
+    };
+
+    if (!initialize && !scramble && !sweep) {
+        std::vector<std::unique_ptr<BufferManager>> bms;
+        std::vector<std::unique_ptr<Workload>> wls;
+        if (_workload == "logging2" && directories.size() > 1)
+            bmlog::warning("You gave more than one directory for logging2. Just using the first directory!");
+
+        // all threads share one buffer pool, it is created with the first buffer manager
+        std::shared_ptr<BufferPool> pool;
+        std::shared_ptr<PMemTier> tier;
+        std::shared_ptr<std::atomic<uint64_t>> ycsb_records;
+        for (unsigned int thread_id = 0; thread_id < num_threads; thread_id++) {
+            uint32_t pattern_seed = suffix_to_seed(buffer_file_suffix) + thread_id;
+            if (_workload != "logging2") {
+                bms.push_back(create_buffer_manager(engine, page_size));
+                BufferManager& bm = *bms.back();
+                if (pool_frames > 0) {
+                    if (!pool) pool = std::make_shared<BufferPool>(pool_frames, page_size, bm.get_mem_alignment(), eviction_policy_factory(pool_frames), directories.size());
+                    bm.attach_pool(pool);
                 }
-                wl = std::make_unique<LoggingWorkload>(bm, total_workload, log_entry_size, suffix_to_seed(buffer_file_suffix), committing);
+                if (!tier_dir.empty()) {
+                    if (!tier) tier = create_tier(page_size, bm.get_total_num_of_pages());
+                    bm.attach_tier(tier);
+                }
+                if (!ycsb_records) ycsb_records = ycsb_record_count(workload_options, page_size, bm.get_total_num_of_pages());
+                wls.push_back(create_workload(workload_options, bm, thread_id, num_threads, pattern_seed, ycsb_records));
             } else {
-                crash("Unsupported workload!");
+                // LOGGING2 - das etwas andere Kind
+                std::string log_suffix = num_threads > 1 ? buffer_file_suffix + "_" + std::to_string(thread_id) : buffer_file_suffix;
+                wls.push_back(std::make_unique<SimpleLoggingWorkload>(directories[0], log_suffix, engine.appendable_file_factory, total_workload, log_entry_size, pattern_seed, random_pages, log_use_fallocate));
             }
-            
-	    wl->run();
-        } else {
-            // LOGGING2 - das etwas andere Kind
-            if (directories.size() > 1)
-                bmlog::warning("You gave more than one directory for logging2. Just using the first directory!");
-                
-            wl = std::make_unique<SimpleLoggingWorkload>(directories[0], buffer_file_suffix, appendable_file_factory, total_workload, log_entry_size, suffix_to_seed(buffer_file_suffix), random_pages, log_use_fallocate);
+        }
+
+        for (auto& wl : wls) wl->set_latency_tracking(track_latency);
+        set_arrivals(wls, rate, arrival_process, suffix_to_seed(buffer_file_suffix));
+        run_workloads(wls, bms, report, perf_scope, run_config);
+
+        if (pool_frames > 0 && !bms.empty()) log_pool_stats(bms, report);
+        if (tier) log_tier_stats(bms, report);
+    } else if (sweep) {
+        if (!output_file.empty()) collect_machine_info(report, directories);
+        uint64_t point = 0;
+        for (auto& point_ioengine : sweep_ioengines) {
+            struct Engine point_engine = select_engine(point_ioengine);
+            placement_config.weights = placement_weights;
+            // the buffer files stay open and mapped for all points of an engine, further threads add buffer managers
+            std::vector<std::unique_ptr<BufferManager>> bms;
+            for (std::size_t point_page_size : sweep_page_sizes) {
+                std::size_t point_pages_per_buffer = buffer_size / point_page_size;
+                std::size_t point_pool_frames = pool_size / point_page_size;
+                // the frames have the page size, so the pool is only kept while it does not change
+                std::shared_ptr<BufferPool> pool;
+                std::shared_ptr<PMemTier> tier;
+                for (auto& bm : bms) {
+                    bm->detach_pool();
+                    bm->set_page_size(point_page_size, point_pages_per_buffer);
+                }
+                for (auto& point_workload : sweep_workloads) {
+                    for (unsigned int point_threads : sweep_threads) {
+                        while (bms.size() < point_threads) bms.push_back(create_buffer_manager(point_engine, point_page_size));
+                        if (point_pool_frames > 0 && !pool) pool = std::make_shared<BufferPool>(point_pool_frames, point_page_size, bms[0]->get_mem_alignment(), eviction_policy_factory(point_pool_frames), directories.size());
+                        if (!tier_dir.empty() && !tier) tier = create_tier(point_page_size, bms[0]->get_total_num_of_pages());
+                        for (auto& bm : bms) {
+                            if (pool && !bm->has_pool()) bm->attach_pool(pool);
+                            if (tier && !bm->has_tier()) bm->attach_tier(tier);
+                        }
+                        for (int point_write_proportion : sweep_write_proportions) {
+                            struct WorkloadOptions point_options = workload_options;
+                            point_options.workload = point_workload;
+                            point_options.write_proportion = point_write_proportion;
+
+                            bmlog::info("");
+                            Report point_report = report;
+                            log_option(point_report, "Sweep Point", point);
+                            log_option(point_report, "Workload", point_workload);
+                            log_option(point_report, "Ioengine", point_ioengine);
+                            log_option(point_report, "Pagesize", point_page_size);
+                            log_option(point_report, "Pages per buffer", point_pages_per_buffer);
+                            log_option(point_report, "Write Proportion", point_write_proportion);
+                            log_option(point_report, "Threads", point_threads);
+                            log_option(point_report, "Repetitions", repetitions);
 
-	    wl->run();
+                            // every metric of a run, in the order it is first reported
+                            std::vector<std::pair<std::string, std::vector<double>>> samples;
+                            for (unsigned int repetition = 0; repetition < repetitions; repetition++) {
+                                auto ycsb_records = ycsb_record_count(point_options, point_page_size, bms[0]->get_total_num_of_pages());
+                                std::vector<std::unique_ptr<Workload>> wls;
+                                for (auto& bm : bms) bm->reset_statistics();
+                                for (unsigned int thread_id = 0; thread_id < point_threads; thread_id++)
+                                    wls.push_back(create_workload(point_options, *bms[thread_id], thread_id, point_threads, suffix_to_seed(buffer_file_suffix) + thread_id, ycsb_records));
+                                for (auto& wl : wls) wl->set_latency_tracking(track_latency);
+                                set_arrivals(wls, rate, arrival_process, suffix_to_seed(buffer_file_suffix));
+
+                                Report run_report;
+                                run_workloads(wls, bms, run_report, perf_scope, run_config);
+                                if (point_pool_frames > 0) log_pool_stats(bms, run_report);
+                                if (tier) log_tier_stats(bms, run_report);
+                                for (const ReportEntry& entry : run_report.get("metrics")) {
+                                    if (entry.is_string) continue;
+                                    auto it = std::find_if(samples.begin(), samples.end(), [&](const auto& s) { return s.first == entry.name; });
+                                    if (it == samples.end()) {
+                                        samples.emplace_back(entry.name, std::vector<double>());
+                                        it = samples.end() - 1;
+                                    }
+                                    it->second.push_back(std::stod(entry.value));
+                                }
+                            }
+                            log_sweep_metrics(point_report, samples);
+                            if (!output_file.empty()) point_report.write(sweep_output_file(output_file, point));
+                            point++;
+                        }
+                    }
+                }
+            }
         }
-       
     } else if (scramble) {
         for (std::string dir : directories) {
             int child_pid = fork();
@@ -261,6 +1103,12 @@ int main(int argc, char *argv[]) {
         while (wait(&status) > -1);
     }
 
+    if (!output_file.empty() && !sweep) {
+        collect_machine_info(report, directories);
+        report.write(output_file);
+        bmlog::info("Results written to " + output_file);
+    }
+
     bmlog::info("Stopped buffer management benchmark");
     return 0;
 }
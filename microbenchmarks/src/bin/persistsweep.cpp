@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argh.h"
+#include "util.hpp"
+#include "copy_kernels.hpp"
+#include "histogram.hpp"
+#include "iowrapper.hpp"
+
+// sweeps write+persist latency and bandwidth over write sizes, engines, offset patterns and thread
+// counts in a single process. Every cell of that matrix becomes one row of the CSV output.
+
+struct SweepTarget {
+    std::string name;
+    // exactly one of the factories is set
+    std::function<IOWrapper*(struct IOWrapperConfig&)> create_io_wrapper;
+    std::function<AppendableFile*(struct IOWrapperConfig&)> create_appendable_file;
+    // O_DIRECT engines only take writes that are multiples of the file system block size
+    bool direct;
+    // whether this machine can run the target at all, nullptr if every machine can
+    bool (*supported)();
+};
+
+struct SweepCell {
+    const SweepTarget *target;
+    bool random;
+    unsigned int threads;
+    std::size_t size;
+};
+
+struct SweepResult {
+    uint64_t operations;
+    uint64_t bytes;
+    double runtime;
+    LatencyHistogram latency;
+};
+
+#ifdef __linux
+// io_uring can be missing from the kernel or disabled by sysctl or seccomp
+static bool kernel_has_io_uring() {
+    struct io_uring ring;
+    if (io_uring_queue_init(1, &ring, 0) < 0) return false;
+    io_uring_queue_exit(&ring);
+    return true;
+}
+#endif
+
+static std::vector<SweepTarget> io_wrapper_targets() {
+    std::vector<SweepTarget> targets = {
+        {"LINUX", create_io_wrapper<LinuxIOWrapper>, nullptr, false, nullptr},
+        {"LINUX_DIRECT", create_io_wrapper<DirectLinuxIOWrapper>, nullptr, true, nullptr},
+        {"MMAP", create_io_wrapper<MmapIOWrapper>, nullptr, false, nullptr},
+        {"MMAP_CLWB", create_io_wrapper<FlushingMmapIOWrapper>, nullptr, false, nullptr},
+        {"MMAP_EADR", create_io_wrapper<EadrMmapIOWrapper>, nullptr, false, nullptr},
+        {"STD", create_io_wrapper<STDIOWrapper>, nullptr, false, nullptr},
+        {"ASM", create_io_wrapper<ASMIOWrapper>, nullptr, false, nullptr},
+        {"ASM_CLWB", create_io_wrapper<ClwbASMIOWrapper>, nullptr, false, cpu_has_clwb},
+    };
+#ifdef __linux
+    targets.push_back({"LIBPMEM2", create_io_wrapper<LibPMIOWrapper>, nullptr, false, nullptr});
+    targets.push_back({"IO_URING", create_io_wrapper<IoUringIOWrapper>, nullptr, false, kernel_has_io_uring});
+    targets.push_back({"IO_URING_DIRECT", create_io_wrapper<DirectIoUringIOWrapper>, nullptr, true, kernel_has_io_uring});
+#endif
+    return targets;
+}
+
+static std::vector<SweepTarget> appendable_file_targets() {
+    std::vector<SweepTarget> targets = {
+        {"LINUX_APPEND", nullptr, create_appendable_file<LinuxAppendableFile>, false, nullptr},
+        {"LINUX_PREALLOC_APPEND", nullptr, create_appendable_file<LinuxPreallocatedAppendableFile>, false, nullptr},
+        {"LINUX_PREFAULT_APPEND", nullptr, create_appendable_file<LinuxPrefaultedAppendableFile>, false, nullptr},
+    };
+#ifdef __linux
+    targets.push_back({"LIBPMEM_APPEND", nullptr, create_appendable_file<LibpmemAppendableFile>, false, nullptr});
+    targets.push_back({"LIBPMEM_PF_APPEND", nullptr, create_appendable_file<LibpmemPrefaultedAppendableFile>, false, nullptr});
+#endif
+    return targets;
+}
+
+// ALL or a comma separated subset of the names in available, NONE for no target at all. ALL skips
+// the targets this machine cannot run, targets named explicitly crash when they are set up instead.
+static std::vector<SweepTarget> select_targets(const std::string& list, const std::vector<SweepTarget>& available) {
+    std::vector<SweepTarget> selected;
+    if (list == "ALL") {
+        for (auto& target : available) {
+            if (target.supported && !target.supported()) {
+                bmlog::warning(("this machine cannot run " + target.name + ", skipping it").c_str());
+                continue;
+            }
+            selected.push_back(target);
+        }
+        return selected;
+    }
+    if (list == "NONE") return selected;
+    for (auto& name : split_list(list)) {
+        auto it = std::find_if(available.begin(), available.end(), [&](const SweepTarget& t) { return t.name == name; });
+        if (it == available.end()) crash("unsupported sweep target " + name);
+        selected.push_back(*it);
+    }
+    return selected;
+}
+
+static struct IOWrapperConfig sweep_config(const std::string& directory, const std::string& suffix, bool mmap_use_map_sync, std::size_t logpool_size) {
+    return IOWrapperConfig{directory.c_str(), suffix.c_str(), false, false, mmap_use_map_sync, logpool_size, false, false, false, false, false, false, 1,
+        DurabilityConfig{DURABILITY_FDATASYNC, 1, 0}, nullptr, nullptr};
+}
+
+// every thread writes to its own region of the buffer file, through its own IOWrapper like bufman's threads
+static SweepResult run_io_wrapper_cell(const SweepCell& cell, const std::string& directory, const std::string& suffix, bool mmap_use_map_sync, uint64_t ops_per_thread, const AlignedMemoryBlock& data) {
+    struct IOWrapperConfig config = sweep_config(directory, suffix, mmap_use_map_sync, 0);
+    std::vector<std::unique_ptr<IOWrapper>> wrappers;
+    for (unsigned int i = 0; i < cell.threads; i++)
+        wrappers.emplace_back(cell.target->create_io_wrapper(config));
+
+    // regions are multiples of every (power of two) write size up to the largest one
+    std::size_t region = (wrappers[0]->get_filesize() / cell.threads) & ~(static_cast<uintmax_t>(cell.size) - 1);
+    if (region < cell.size)
+        crash("the buffer file is too small for " + std::to_string(cell.threads) + " threads writing " + std::to_string(cell.size) + " B each");
+    uint64_t slots = region / cell.size;
+
+    std::vector<LatencyHistogram> latencies(cell.threads);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < cell.threads; i++) {
+        threads.emplace_back([&, i]() {
+            std::mt19937 gen = CustomSeededEngine(i);
+            std::uniform_int_distribution<uint64_t> slot_dis(0, slots - 1);
+            for (uint64_t op = 0; op < ops_per_thread; op++) {
+                uint64_t slot = cell.random ? slot_dis(gen) : op % slots;
+                uint64_t op_start = now_ns();
+                wrappers[i]->write(*data, i * region + slot * cell.size, cell.size);
+                latencies[i].record(now_ns() - op_start);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::chrono::duration<double> runtime = std::chrono::steady_clock::now() - start;
+
+    SweepResult result{ops_per_thread * cell.threads, ops_per_thread * cell.threads * cell.size, runtime.count(), LatencyHistogram()};
+    for (auto& latency : latencies) result.latency.merge(latency);
+    return result;
+}
+
+// appends only have one pattern, every thread appends to its own file that is removed afterwards
+static SweepResult run_appendable_file_cell(const SweepCell& cell, const std::string& directory, const std::string& suffix, uint64_t ops_per_thread, const AlignedMemoryBlock& data) {
+    std::vector<std::string> suffixes;
+    std::vector<std::unique_ptr<AppendableFile>> files;
+    for (unsigned int i = 0; i < cell.threads; i++) {
+        suffixes.push_back(suffix + "_sweep_" + std::to_string(i));
+        // 200 MiB more for metadata in case of libpmemlog, as logging2 does
+        struct IOWrapperConfig config = sweep_config(directory, suffixes.back(), false, ops_per_thread * cell.size + (200 << 20));
+        files.emplace_back(cell.target->create_appendable_file(config));
+    }
+
+    std::vector<LatencyHistogram> latencies(cell.threads);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < cell.threads; i++) {
+        threads.emplace_back([&, i]() {
+            for (uint64_t op = 0; op < ops_per_thread; op++) {
+                uint64_t op_start = now_ns();
+                files[i]->append(*data, cell.size);
+                latencies[i].record(now_ns() - op_start);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::chrono::duration<double> runtime = std::chrono::steady_clock::now() - start;
+
+    files.clear();
+    for (auto& file_suffix : suffixes) std::remove((directory + BUFFER_FILE_BASENAME + file_suffix).c_str());
+
+    SweepResult result{ops_per_thread * cell.threads, ops_per_thread * cell.threads * cell.size, runtime.count(), LatencyHistogram()};
+    for (auto& latency : latencies) result.latency.merge(latency);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    prepare_logging();
+
+    argh::parser cmdl;
+    cmdl.add_params({"-i", "--ioengines", "--appenders", "-s", "--suffix", "--min-size", "--max-size", "--threads", "--patterns", "--ops", "--cell-bytes", "-o", "--output"});
+    cmdl.parse(argc, argv);
+
+    std::vector<std::string> directories;
+    std::copy(cmdl.pos_args().begin() + 1, cmdl.pos_args().end(), std::back_inserter(directories));
+    if (directories.empty())
+        crash("no mount given");
+    if (directories.size() > 1)
+        bmlog::warning("You gave more than one directory for the sweep. Just using the first directory!");
+    std::string directory = directories[0];
+
+    // the IOWrappers write into the buffer file bufman --initialize creates
+    std::string buffer_file_suffix;
+    cmdl({"-s", "--suffix"}) >> buffer_file_suffix;
+
+    std::string ioengines, appenders;
+    cmdl({"-i", "--ioengines"}, "ALL") >> ioengines;
+    cmdl({"--appenders"}, "ALL") >> appenders;
+    std::vector<SweepTarget> targets = select_targets(ioengines, io_wrapper_targets());
+    for (auto& target : select_targets(appenders, appendable_file_targets())) targets.push_back(target);
+    if (targets.empty())
+        crash("neither ioengines nor appenders to sweep");
+
+    std::size_t min_size, max_size; // B, powers of two
+    cmdl({"--min-size"}, 8) >> min_size;
+    cmdl({"--max-size"}, 2 << 20) >> max_size;
+    if (__builtin_popcountll(min_size) != 1 || __builtin_popcountll(max_size) != 1 || min_size > max_size)
+        crash("write sizes have to be powers of two with --min-size <= --max-size");
+
+    std::string thread_list, pattern_list;
+    cmdl({"--threads"}, "1,2,4,8") >> thread_list;
+    cmdl({"--patterns"}, "SEQUENTIAL,RANDOM") >> pattern_list;
+    std::vector<unsigned int> thread_counts;
+    for (auto& count : split_list(thread_list)) {
+        unsigned int threads = static_cast<unsigned int>(std::stoul(count));
+        if (threads == 0) crash("invalid thread count " + count);
+        thread_counts.push_back(threads);
+    }
+    std::vector<bool> patterns;
+    for (auto& pattern : split_list(pattern_list)) {
+        if (pattern == "SEQUENTIAL") patterns.push_back(false);
+        else if (pattern == "RANDOM") patterns.push_back(true);
+        else crash("unsupported offset pattern " + pattern);
+    }
+
+    uint64_t ops; // writes per thread and cell
+    cmdl({"--ops"}, 1000) >> ops;
+    uint64_t cell_bytes; // MiB per thread and cell, caps ops for large writes
+    cmdl({"--cell-bytes"}, 256) >> cell_bytes;
+    cell_bytes <<= 20;
+
+    bool mmap_use_map_sync = false;
+    if (cmdl[{"--mapsync"}]) mmap_use_map_sync = true;
+
+    std::string output_file;
+    cmdl({"-o", "--output"}) >> output_file;
+
+    bmlog::info("Starting persist cost sweep");
+    bmlog::info("Mount: " + directory);
+    bmlog::info("Write Sizes (B): " + std::to_string(min_size) + " - " + std::to_string(max_size));
+    bmlog::info("Threads: " + thread_list);
+    bmlog::info("Patterns: " + pattern_list);
+    bmlog::info("Operations per Thread: " + std::to_string(ops));
+    bmlog::info("Using map_sync for mmap: " + std::to_string(mmap_use_map_sync));
+    bmlog::info("");
+
+    std::ofstream csv;
+    if (!output_file.empty()) {
+        csv.open(output_file);
+        if (!csv) crash("could not open " + output_file);
+        csv << "target,pattern,threads,size,operations,bytes,runtime_s,bandwidth_mib_s,throughput_ops_s,latency_mean_ns,latency_p50_ns,latency_p99_ns,latency_p99_9_ns,latency_max_ns\n";
+    }
+
+    // the largest write, every write starts at its beginning
+    AlignedMemoryBlock data(4096, max_size);
+    std::mt19937 gen = CustomSeededEngine(suffix_to_seed(buffer_file_suffix));
+    std::uniform_int_distribution<int> byte_dis(0, 255);
+    for (std::size_t i = 0; i < max_size; i++) static_cast<char*>(*data)[i] = static_cast<char>(byte_dis(gen));
+
+    uint32_t block_size = 0;
+    for (auto& target : targets) {
+        for (bool random : patterns) {
+            if (target.create_appendable_file && random) continue;
+            for (unsigned int threads : thread_counts) {
+                for (std::size_t size = min_size; size <= max_size; size <<= 1) {
+                    if (target.direct) {
+                        if (block_size == 0) {
+                            struct IOWrapperConfig config = sweep_config(directory, buffer_file_suffix, false, 0);
+                            std::unique_ptr<IOWrapper> probe(target.create_io_wrapper(config));
+                            block_size = probe->get_alignment();
+                        }
+                        // O_DIRECT rejects writes that are not block multiples
+                        if (size % block_size != 0) continue;
+                    }
+                    SweepCell cell{&target, random, threads, size};
+                    uint64_t ops_per_thread = std::min(ops, std::max(cell_bytes / size, static_cast<uint64_t>(1)));
+                    SweepResult result = target.create_io_wrapper
+                        ? run_io_wrapper_cell(cell, directory, buffer_file_suffix, mmap_use_map_sync, ops_per_thread, data)
+                        : run_appendable_file_cell(cell, directory, buffer_file_suffix, ops_per_thread, data);
+
+                    const char *pattern = target.create_appendable_file ? "APPEND" : random ? "RANDOM" : "SEQUENTIAL";
+                    double bandwidth = static_cast<double>(result.bytes) / (1 << 20) / result.runtime;
+                    double throughput = result.operations / result.runtime;
+                    bmlog::info(target.name + " " + pattern + " " + std::to_string(threads) + "T " + std::to_string(size) + " B: "
+                        + std::to_string(bandwidth) + " MiB/s, p50 " + std::to_string(result.latency.percentile(50)) + " ns, p99 "
+                        + std::to_string(result.latency.percentile(99)) + " ns");
+                    if (csv.is_open()) {
+                        csv << target.name << ',' << pattern << ',' << threads << ',' << size << ',' << result.operations << ','
+                            << result.bytes << ',' << result.runtime << ',' << bandwidth << ',' << throughput << ','
+                            << result.latency.get_mean() << ',' << result.latency.percentile(50) << ',' << result.latency.percentile(99) << ','
+                            << result.latency.percentile(99.9) << ',' << result.latency.get_max() << '\n';
+                        csv.flush();
+                    }
+                }
+            }
+        }
+    }
+
+    if (csv.is_open()) bmlog::info("Results written to " + output_file);
+    bmlog::info("Stopped persist cost sweep");
+    return 0;
+}
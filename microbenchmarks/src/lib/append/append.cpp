@@ -5,7 +5,7 @@
 
 #include "iowrapper.hpp"
 
-uint32_t IOWrapper::get_alignment() {
+uint32_t AppendableFile::get_alignment() {
     struct stat fstat;
     stat(get_filename(), &fstat);
     uint32_t blksize = static_cast<uint32_t>(fstat.st_blksize);
@@ -13,7 +13,7 @@ uint32_t IOWrapper::get_alignment() {
     return blksize;
 }
 
-uintmax_t IOWrapper::get_filesize() const {
+uintmax_t AppendableFile::get_filesize() const {
     std::filesystem::path p{get_filename()};
     return std::filesystem::file_size(p);
 }
@@ -0,0 +1,28 @@
+#include <chrono>
+#include <thread>
+
+#include "arrivals.hpp"
+#include "histogram.hpp"
+#include "util.hpp"
+
+// sleeping is only precise to some tens of microseconds, the rest is spun
+#define ARRIVAL_SPIN_NS 100000
+
+ArrivalSchedule::ArrivalSchedule(double rate, ArrivalProcess process, uint32_t seed)
+    : interval_ns(1e9 / rate), process(process), generator(CustomSeededEngine(seed)), interval_dis(1.0 / interval_ns), started(false), next_ns(0) {
+    if (rate <= 0) crash("the arrival rate has to be positive");
+}
+
+uint64_t ArrivalSchedule::wait_next() {
+    if (!started) {
+        started = true;
+        next_ns = static_cast<double>(now_ns());
+    } else {
+        next_ns += process == ARRIVALS_POISSON ? interval_dis(generator) : interval_ns;
+    }
+    uint64_t intended = static_cast<uint64_t>(next_ns);
+    uint64_t now = now_ns();
+    if (now + ARRIVAL_SPIN_NS < intended) std::this_thread::sleep_for(std::chrono::nanoseconds(intended - now - ARRIVAL_SPIN_NS));
+    while (now_ns() < intended) {}
+    return intended;
+}
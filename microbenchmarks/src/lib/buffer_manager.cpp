@@ -1,12 +1,24 @@
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <thread>
 #include <vector>
 #include <numeric>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "buffer_manager.hpp"
 #include "termcolor/termcolor.h"
 #include "util.hpp"
 
+// dirty frames written back with one batch when the pool is flushed
+#define BM_FLUSH_BATCH_PAGES 64
+// read from every mount to measure its bandwidth, in chunks of BM_BANDWIDTH_PROBE_CHUNK
+#define BM_BANDWIDTH_PROBE_BYTES (256 << 20)
+#define BM_BANDWIDTH_PROBE_CHUNK (1 << 20)
+#define BM_BANDWIDTH_PROBE_ALIGNMENT 4096
+
 bool ok(const BMStatus status) {
     switch (status) {
     case BM_READ_FAILURE:
@@ -18,20 +30,34 @@ bool ok(const BMStatus status) {
     return true;
 }
 
-BufferManager::BufferManager(std::vector<std::string>& dirs, const char *file_suffix, const std::size_t page_size, const std::size_t pages_per_buffer_file, const bool use_fadvise, const bool pmem_use_cacheline_granularity,  const bool mmap_use_map_sync,  std::function<IOWrapper*(struct IOWrapperConfig&)> create_io_wrapper, const bool fadv_random, const bool fadv_sequential, const bool madv_random, const bool madv_sequential, const bool mmap_populate)
- : page_size(page_size), pages_per_buffer_file(pages_per_buffer_file) {
+BufferManager::BufferManager(std::vector<std::string>& dirs, const char *file_suffix, const std::size_t page_size, const std::size_t pages_per_buffer_file, const bool use_fadvise, const bool pmem_use_cacheline_granularity,  const bool mmap_use_map_sync,  std::function<IOWrapper*(struct IOWrapperConfig&)> create_io_wrapper, const bool fadv_random, const bool fadv_sequential, const bool madv_random, const bool madv_sequential, const bool mmap_populate, const bool uring_sqpoll, const unsigned int queue_depth, const struct DurabilityConfig& durability, const char *read_kernel, const char *write_kernel)
+ : page_size(page_size), pages_per_buffer_file(pages_per_buffer_file), create_placement(create_page_placement<StripedPlacement>), placement_config{1, {}}, pool_stats{0, 0, 0, 0}, tier_stats{0, 0, 0, 0, 0} {
     std::for_each(dirs.begin(), dirs.end(), [&](std::string& dir) {
-        struct IOWrapperConfig config{dir.c_str(), file_suffix, use_fadvise, pmem_use_cacheline_granularity, mmap_use_map_sync, 0, fadv_random, fadv_sequential, madv_random, madv_sequential, mmap_populate};
-        auto newBuf = create_io_wrapper(config);
-        if (pages_per_buffer_file * page_size > newBuf->get_filesize())  {
-            crash("VERY SAD FAKE NEWS: buffer in directory "  + dir + " is too small :C");
-        }
-
-        buffers.push_back(newBuf);
+        add_mount(dir, create_io_wrapper, {nullptr, file_suffix, use_fadvise, pmem_use_cacheline_granularity, mmap_use_map_sync, 0, fadv_random, fadv_sequential, madv_random, madv_sequential, mmap_populate, uring_sqpoll, queue_depth, durability, read_kernel, write_kernel});
     });
+    placement.reset(create_placement(buffers.size(), pages_per_buffer_file, placement_config));
+}
+
+BufferManager::BufferManager(const std::vector<struct Mount>& mounts, const std::size_t page_size, const std::size_t pages_per_buffer_file)
+ : page_size(page_size), pages_per_buffer_file(pages_per_buffer_file), create_placement(create_page_placement<StripedPlacement>), placement_config{1, {}}, pool_stats{0, 0, 0, 0}, tier_stats{0, 0, 0, 0, 0} {
+    for (const struct Mount& mount : mounts) add_mount(mount.directory, mount.create_io_wrapper, mount.config);
+    placement.reset(create_placement(buffers.size(), pages_per_buffer_file, placement_config));
+}
+
+void BufferManager::add_mount(const std::string& dir, const std::function<IOWrapper*(struct IOWrapperConfig&)>& create_io_wrapper, struct IOWrapperConfig config) {
+    config.directory = dir.c_str();
+    auto newBuf = create_io_wrapper(config);
+    if (pages_per_buffer_file * page_size > newBuf->get_filesize())  {
+        crash("VERY SAD FAKE NEWS: buffer in directory "  + dir + " is too small :C");
+    }
+
+    buffers.push_back(newBuf);
+    buffer_files.push_back(dir + BUFFER_FILE_BASENAME + config.file_suffix);
 }
 
 BufferManager::~BufferManager() {
+    if (pool && !ok(flush())) bmlog::error("could not write back dirty pages of the buffer pool");
+    if (tier && !ok(flush_tier())) bmlog::error("could not write back dirty pages of the PMem tier");
     for (IOWrapper *w : buffers) delete w;
 }
 
@@ -43,20 +69,65 @@ BMStatus BufferManager::pagein(void *dest, const uint64_t page_id) {
         return BM_READ_FAILURE;
     }
     std::size_t position = internal_page_id * page_size;
+    uint64_t start = track_latency ? now_ns() : 0;
     if (responsibleWrapper->read(dest, position, page_size) != 0) {
         return BM_READ_FAILURE;
     }
+    if (track_latency) pagein_latency.record(now_ns() - start);
     return BM_READ_SUCCESS;
 }
 
 int BufferManager::lookup(IOWrapper **responsible_wrapper, uint64_t *internal_id, const uint64_t page_id) {
-    if (page_id >= buffers.size() * pages_per_buffer_file) return -1;
-    std::size_t bufferId = page_id % buffers.size();
+    std::size_t bufferId;
+    if (lookup_index(&bufferId, internal_id, page_id) != 0) return -1;
     *responsible_wrapper = buffers[bufferId];
-    *internal_id = page_id / buffers.size();
     return 0;
 }
 
+int BufferManager::lookup_index(std::size_t *buffer_id, uint64_t *internal_id, const uint64_t page_id) {
+    if (page_id >= placement->get_num_pages()) return -1;
+    placement->place(page_id, buffer_id, internal_id);
+    return 0;
+}
+
+int BufferManager::split_batch(const std::vector<std::pair<uint64_t, void*>>& pages) {
+    batches.resize(buffers.size());
+    for (auto& batch : batches) batch.clear();
+    for (auto& page : pages) {
+        std::size_t buffer_id;
+        uint64_t internal_page_id;
+        if (lookup_index(&buffer_id, &internal_page_id, page.first) != 0) return -1;
+        batches[buffer_id].push_back({page.second, internal_page_id * page_size, page_size});
+    }
+    return 0;
+}
+
+BMStatus BufferManager::pagein_batch(const std::vector<std::pair<uint64_t, void*>>& pages) {
+    if (split_batch(pages) != 0) {
+        bmlog::error("tried to read from invalid page id");
+        return BM_READ_FAILURE;
+    }
+    uint64_t start = track_latency ? now_ns() : 0;
+    for (std::size_t i = 0; i < buffers.size(); i++) {
+        if (!batches[i].empty() && buffers[i]->read_batch(batches[i]) != 0) return BM_READ_FAILURE;
+    }
+    if (track_latency) pagein_batch_latency.record(now_ns() - start);
+    return BM_READ_SUCCESS;
+}
+
+BMStatus BufferManager::pageout_batch(const std::vector<std::pair<uint64_t, void*>>& pages) {
+    if (split_batch(pages) != 0) {
+        bmlog::error("tried to write to invalid page id");
+        return BM_WRITE_FAILURE;
+    }
+    uint64_t start = track_latency ? now_ns() : 0;
+    for (std::size_t i = 0; i < buffers.size(); i++) {
+        if (!batches[i].empty() && buffers[i]->write_batch(batches[i]) != 0) return BM_WRITE_FAILURE;
+    }
+    if (track_latency) pageout_batch_latency.record(now_ns() - start);
+    return BM_WRITE_SUCCESS;
+}
+
 BMStatus BufferManager::pageout(void *src, const uint64_t page_id) {
     IOWrapper *responsibleWrapper;
     uint64_t internal_page_id;
@@ -65,15 +136,405 @@ BMStatus BufferManager::pageout(void *src, const uint64_t page_id) {
         return BM_WRITE_FAILURE;
     }
     std::size_t position = internal_page_id * page_size;
+    uint64_t start = track_latency ? now_ns() : 0;
     if (responsibleWrapper->write(src, position, page_size) != 0) {
         return BM_WRITE_FAILURE;
     }
-    return BM_WRITE_FAILURE;
+    if (track_latency) pageout_latency.record(now_ns() - start);
+    return BM_WRITE_SUCCESS;
+}
+
+BMStatus BufferManager::submit_pagein(void *dest, const uint64_t page_id, const uint64_t tag) {
+    IOWrapper *responsibleWrapper;
+    uint64_t internal_page_id;
+    if (lookup(&responsibleWrapper, &internal_page_id, page_id) != 0) {
+        bmlog::error("tried to read from invalid page id");
+        return BM_READ_FAILURE;
+    }
+    std::size_t position = internal_page_id * page_size;
+    if (responsibleWrapper->submit_read(dest, position, page_size, tag) != 0) {
+        return BM_READ_FAILURE;
+    }
+    return BM_READ_SUCCESS;
+}
+
+BMStatus BufferManager::submit_pageout(void *src, const uint64_t page_id, const uint64_t tag) {
+    IOWrapper *responsibleWrapper;
+    uint64_t internal_page_id;
+    if (lookup(&responsibleWrapper, &internal_page_id, page_id) != 0) {
+        bmlog::error("tried to write to invalid page id");
+        return BM_WRITE_FAILURE;
+    }
+    std::size_t position = internal_page_id * page_size;
+    if (responsibleWrapper->submit_write(src, position, page_size, tag) != 0) {
+        return BM_WRITE_FAILURE;
+    }
+    return BM_WRITE_SUCCESS;
+}
+
+std::size_t BufferManager::collect(std::vector<BMCompletion>& completions) {
+    for (const IOCompletion& c : io_completions) {
+        BMStatus status;
+        if (c.is_write)
+            status = c.result == 0 ? BM_WRITE_SUCCESS : BM_WRITE_FAILURE;
+        else
+            status = c.result == 0 ? BM_READ_SUCCESS : BM_READ_FAILURE;
+        completions.push_back({c.tag, status});
+    }
+    std::size_t num_completed = io_completions.size();
+    io_completions.clear();
+    return num_completed;
+}
+
+std::size_t BufferManager::poll(std::vector<BMCompletion>& completions) {
+    for (IOWrapper *w : buffers) w->poll(io_completions);
+    return collect(completions);
+}
+
+std::size_t BufferManager::wait(std::vector<BMCompletion>& completions, const std::size_t min_completions) {
+    for (IOWrapper *w : buffers) w->poll(io_completions);
+    // block on the wrappers in turn until enough requests are done or nothing is left in flight
+    bool any_inflight = true;
+    while (io_completions.size() < min_completions && any_inflight) {
+        any_inflight = false;
+        for (IOWrapper *w : buffers) {
+            if (w->inflight() == 0) continue;
+            any_inflight = true;
+            w->wait(io_completions, 1);
+            if (io_completions.size() >= min_completions) break;
+        }
+    }
+    return collect(completions);
+}
+
+void BufferManager::register_buffers(const std::vector<struct iovec>& memory) {
+    std::vector<struct iovec> all_memory(memory);
+    if (pool) {
+        // the frames are paged in and out directly, io_uring takes at most 1 GiB per fixed buffer
+        constexpr std::size_t max_chunk = static_cast<std::size_t>(1) << 30;
+        std::size_t pool_bytes = pool->get_num_frames() * page_size;
+        char *pool_start = static_cast<char*>(pool->data(0));
+        for (std::size_t offset = 0; offset < pool_bytes; offset += max_chunk) {
+            all_memory.push_back({pool_start + offset, std::min(max_chunk, pool_bytes - offset)});
+        }
+    }
+    for (IOWrapper *w : buffers) w->register_buffers(all_memory);
+}
+
+void BufferManager::attach_pool(std::shared_ptr<BufferPool> new_pool) {
+    pool = new_pool;
+    register_buffers({});
+}
+
+void BufferManager::detach_pool() {
+    if (!pool) return;
+    if (!ok(flush())) crash("could not write back dirty pages of the buffer pool");
+    if (tier) {
+        if (!ok(flush_tier())) crash("could not write back dirty pages of the PMem tier");
+        tier.reset();
+        tier_staging.reset();
+    }
+    pool.reset();
+    register_buffers({});
+}
+
+bool BufferManager::has_pool() const {
+    return static_cast<bool>(pool);
+}
+
+const BufferPool& BufferManager::get_pool() const {
+    return *pool;
+}
+
+const BufferPoolStats& BufferManager::get_pool_stats() const {
+    return pool_stats;
+}
+
+void BufferManager::attach_tier(std::shared_ptr<PMemTier> new_tier) {
+    if (!pool) crash("the PMem tier needs a buffer pool in front of it");
+    tier = new_tier;
+    tier_staging = std::make_unique<AlignedMemoryBlock>(std::lcm(get_mem_alignment(), tier->get_alignment()), page_size);
+}
+
+bool BufferManager::has_tier() const {
+    return static_cast<bool>(tier);
+}
+
+const TierStats& BufferManager::get_tier_stats() const {
+    return tier_stats;
+}
+
+void *BufferManager::pin(const uint64_t page_id) {
+    if (page_id >= get_total_num_of_pages()) return nullptr;
+    if (tier) tier->touch(page_id);
+    return fetch(page_id);
+}
+
+void *BufferManager::fetch(const uint64_t page_id) {
+    for (;;) {
+        std::size_t frame_id = pool->pin_resident(page_id);
+        if (frame_id != INVALID_FRAME_ID) {
+            pool_stats.hits++;
+            return pool->data(frame_id);
+        }
+
+        frame_id = pool->evict();
+        Frame& victim = pool->frame(frame_id);
+        uint64_t victim_page_id = victim.page_id.load(std::memory_order_relaxed);
+        bool victim_dirty = victim_page_id != INVALID_PAGE_ID && victim.dirty.load(std::memory_order_relaxed);
+        // clean pages can still move down into the tier
+        if (victim_dirty || (tier && victim_page_id != INVALID_PAGE_ID)) {
+            if (evict_page(pool->data(frame_id), victim_page_id, victim_dirty) != BM_WRITE_SUCCESS) crash("could not write back page " + std::to_string(victim_page_id));
+        }
+        if (victim_dirty) {
+            victim.dirty.store(false, std::memory_order_relaxed);
+            pool_stats.writebacks++;
+        }
+        if (!pool->install(frame_id, page_id)) {
+            // another thread is already loading this page
+            pool->release(frame_id);
+            continue;
+        }
+        if (victim_page_id != INVALID_PAGE_ID) pool_stats.evictions++;
+        pool_stats.misses++;
+
+        if (load(pool->data(frame_id), page_id) != BM_READ_SUCCESS) crash("could not read page " + std::to_string(page_id));
+        pool->loaded(frame_id);
+        return pool->data(frame_id);
+    }
+}
+
+void BufferManager::unpin(const uint64_t page_id, const bool dirty) {
+    std::size_t frame_id = pool->find(page_id);
+    if (frame_id == INVALID_FRAME_ID) crash("tried to unpin page " + std::to_string(page_id) + " which is not in the buffer pool");
+    pool->unpin(frame_id, dirty);
+}
+
+BMStatus BufferManager::read_page(const uint64_t page_id, void *dest) {
+    if (page_id >= get_total_num_of_pages()) return BM_READ_FAILURE;
+    if (tier) tier->touch(page_id);
+    if (tier && tier->get_config().read_in_place) {
+        std::size_t frame_id = pool->pin_resident(page_id);
+        if (frame_id != INVALID_FRAME_ID) {
+            pool_stats.hits++;
+            std::memcpy(dest, pool->data(frame_id), page_size);
+            pool->unpin(frame_id, false);
+            return BM_READ_SUCCESS;
+        }
+        // not in DRAM, so the tier has the current version if it has the page at all
+        std::size_t slot_id = tier->pin_resident(page_id);
+        if (slot_id != INVALID_FRAME_ID) {
+            int result = tier->read(slot_id, dest);
+            tier->unpin(slot_id);
+            if (result != 0) return BM_READ_FAILURE;
+            tier_stats.in_place_reads++;
+            return BM_READ_SUCCESS;
+        }
+    }
+    void *frame = fetch(page_id);
+    std::memcpy(dest, frame, page_size);
+    unpin(page_id, false);
+    return BM_READ_SUCCESS;
+}
+
+BMStatus BufferManager::load(void *dest, const uint64_t page_id) {
+    if (tier) {
+        std::size_t slot_id = tier->pin_resident(page_id);
+        if (slot_id != INVALID_FRAME_ID) {
+            int result = tier->read(slot_id, dest);
+            tier->unpin(slot_id);
+            if (result != 0) return BM_READ_FAILURE;
+            tier_stats.hits++;
+            return BM_READ_SUCCESS;
+        }
+    }
+    BMStatus status = pagein(dest, page_id);
+    if (tier && ok(status) && tier->is_hot(page_id)) promote(dest, page_id, false);
+    return status;
+}
+
+BMStatus BufferManager::evict_page(void *src, const uint64_t page_id, const bool dirty) {
+    if (tier) {
+        BMStatus status;
+        if (dirty && write_to_tier(src, page_id, &status)) return status;
+        if (!dirty && tier->contains(page_id)) return BM_WRITE_SUCCESS;
+        if (tier->is_hot(page_id) && promote(src, page_id, dirty)) return BM_WRITE_SUCCESS;
+    }
+    return dirty ? pageout(src, page_id) : BM_WRITE_SUCCESS;
+}
+
+bool BufferManager::write_to_tier(void *src, const uint64_t page_id, BMStatus *status) {
+    std::size_t slot_id = tier->lock_resident(page_id);
+    if (slot_id == INVALID_FRAME_ID) return false;
+    // the slot gets the newest version, the buffer file only once the page is demoted
+    int result = tier->write(slot_id, src);
+    tier->release(slot_id, result == 0);
+    *status = result == 0 ? BM_WRITE_SUCCESS : BM_WRITE_FAILURE;
+    return true;
+}
+
+bool BufferManager::promote(void *src, const uint64_t page_id, const bool dirty) {
+    std::size_t slot_id = tier->demote();
+    if (slot_id == INVALID_FRAME_ID) return false;
+    Frame& victim = tier->slot(slot_id);
+    uint64_t victim_page_id = victim.page_id.load(std::memory_order_relaxed);
+    if (victim_page_id != INVALID_PAGE_ID && victim.dirty.load(std::memory_order_relaxed)) {
+        // the slot holds the only current version of the demoted page
+        if (tier->read(slot_id, **tier_staging) != 0 || pageout(**tier_staging, victim_page_id) != BM_WRITE_SUCCESS)
+            crash("could not write back page " + std::to_string(victim_page_id) + " demoted from the PMem tier");
+        victim.dirty.store(false, std::memory_order_relaxed);
+        tier_stats.writebacks++;
+    }
+    if (!tier->install(slot_id, page_id)) {
+        tier->release(slot_id, false);
+        return false;
+    }
+    if (victim_page_id != INVALID_PAGE_ID) tier_stats.demotions++;
+    if (tier->write(slot_id, src) != 0) crash("could not write page " + std::to_string(page_id) + " to the PMem tier");
+    tier->release(slot_id, dirty);
+    tier_stats.promotions++;
+    return true;
+}
+
+BMStatus BufferManager::flush_tier() {
+    for (std::size_t slot_id = 0; slot_id < tier->get_num_slots(); slot_id++) {
+        Frame& s = tier->slot(slot_id);
+        if (!s.dirty.load(std::memory_order_relaxed) || !tier->try_lock(slot_id)) continue;
+        uint64_t page_id = s.page_id.load(std::memory_order_relaxed);
+        if (page_id == INVALID_PAGE_ID || !s.dirty.load(std::memory_order_relaxed)) {
+            tier->release(slot_id, false);
+            continue;
+        }
+        bool written = tier->read(slot_id, **tier_staging) == 0 && pageout(**tier_staging, page_id) == BM_WRITE_SUCCESS;
+        if (written) {
+            s.dirty.store(false, std::memory_order_relaxed);
+            tier_stats.writebacks++;
+        }
+        tier->release(slot_id, false);
+        if (!written) return BM_WRITE_FAILURE;
+    }
+    return BM_WRITE_SUCCESS;
+}
+
+BMStatus BufferManager::flush() {
+    // the dirty frames are locked and written back BM_FLUSH_BATCH_PAGES at a time
+    auto write_back = [&]() {
+        BMStatus status = flush_batch.empty() ? BM_WRITE_SUCCESS : pageout_batch(flush_batch);
+        // the frames are still locked, so nobody dirtied them again in between
+        for (std::size_t frame_id : flush_frames) {
+            if (ok(status)) {
+                pool->frame(frame_id).dirty.store(false, std::memory_order_relaxed);
+                pool_stats.writebacks++;
+            }
+            pool->release(frame_id);
+        }
+        flush_batch.clear();
+        flush_frames.clear();
+        return status;
+    };
+    // frames that are pinned by someone else right now are left to them
+    for (std::size_t frame_id = 0; frame_id < pool->get_num_frames(); frame_id++) {
+        Frame& f = pool->frame(frame_id);
+        if (!f.dirty.load(std::memory_order_relaxed) || !pool->try_lock(frame_id)) continue;
+        uint64_t page_id = f.page_id.load(std::memory_order_relaxed);
+        if (page_id == INVALID_PAGE_ID || !f.dirty.load(std::memory_order_relaxed)) {
+            pool->release(frame_id);
+            continue;
+        }
+        BMStatus status;
+        if (tier && write_to_tier(pool->data(frame_id), page_id, &status)) {
+            if (ok(status)) {
+                f.dirty.store(false, std::memory_order_relaxed);
+                pool_stats.writebacks++;
+            }
+            pool->release(frame_id);
+            if (!ok(status)) return status;
+            continue;
+        }
+        flush_frames.push_back(frame_id);
+        flush_batch.emplace_back(page_id, pool->data(frame_id));
+        if (flush_frames.size() == BM_FLUSH_BATCH_PAGES && !ok(write_back())) return BM_WRITE_FAILURE;
+    }
+    return write_back();
+}
+
+void BufferManager::set_latency_tracking(const bool enabled) {
+    track_latency = enabled;
+}
+
+std::vector<std::pair<std::string, const LatencyHistogram*>> BufferManager::get_latencies() const {
+    return {{"Pagein", &pagein_latency}, {"Pageout", &pageout_latency}, {"Pagein Batch", &pagein_batch_latency}, {"Pageout Batch", &pageout_batch_latency}};
+}
+
+void BufferManager::set_page_size(const std::size_t page_size, const std::size_t pages_per_buffer_file) {
+    if (pool) crash("the page size cannot change while a buffer pool is attached");
+    for (IOWrapper *w : buffers) {
+        if (pages_per_buffer_file * page_size > w->get_filesize()) crash("buffer is too small for " + std::to_string(pages_per_buffer_file) + " pages of " + std::to_string(page_size) + " B");
+    }
+    this->page_size = page_size;
+    this->pages_per_buffer_file = pages_per_buffer_file;
+    placement.reset(create_placement(buffers.size(), pages_per_buffer_file, placement_config));
+}
+
+void BufferManager::set_placement(std::function<PagePlacement*(std::size_t, uint64_t, const struct PlacementConfig&)> create_placement, const struct PlacementConfig& config) {
+    if (pool) crash("the placement cannot change while a buffer pool is attached");
+    this->create_placement = create_placement;
+    placement_config = config;
+    placement.reset(create_placement(buffers.size(), pages_per_buffer_file, placement_config));
+}
+
+std::vector<double> BufferManager::measure_bandwidth(const unsigned int queue_depth) {
+    std::size_t probe_bytes = std::min(static_cast<std::size_t>(BM_BANDWIDTH_PROBE_BYTES), pages_per_buffer_file * page_size);
+    std::size_t chunk_len = std::min(static_cast<std::size_t>(BM_BANDWIDTH_PROBE_CHUNK), probe_bytes);
+    std::size_t num_chunks = probe_bytes / chunk_len;
+    std::vector<AlignedMemoryBlock> chunks;
+    for (unsigned int i = 0; i < queue_depth; i++) chunks.emplace_back(BM_BANDWIDTH_PROBE_ALIGNMENT, chunk_len);
+
+    std::vector<double> bandwidths;
+    for (const std::string& file : buffer_files) {
+        int fd = open(file.c_str(), O_RDONLY | O_DIRECT);
+        if (fd == -1) {
+            fd = open(file.c_str(), O_RDONLY);
+            if (fd == -1) {
+                perror("open");
+                crash("could not open buffer file " + file + " to measure its bandwidth");
+            }
+            bmlog::warning(("no O_DIRECT for " + file + ", dropping its cached pages before measuring its bandwidth").c_str());
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+
+        // every reader takes the next chunk, so the file is read front to back with queue_depth chunks in flight
+        std::atomic<std::size_t> next_chunk{0};
+        std::atomic<bool> failed{false};
+        uint64_t start = now_ns();
+        std::vector<std::thread> readers;
+        for (unsigned int i = 0; i < queue_depth; i++) {
+            readers.emplace_back([&, i]() {
+                for (std::size_t c = next_chunk++; c < num_chunks; c = next_chunk++) {
+                    if (pread(fd, *chunks[i], chunk_len, c * chunk_len) != static_cast<ssize_t>(chunk_len)) failed = true;
+                }
+            });
+        }
+        for (auto& reader : readers) reader.join();
+        double seconds = std::max(now_ns() - start, static_cast<uint64_t>(1)) / 1e9;
+        close(fd);
+        if (failed) crash("could not read buffer file " + file + " to measure its bandwidth");
+        bandwidths.push_back(static_cast<double>(num_chunks * chunk_len) / (1 << 20) / seconds);
+    }
+    return bandwidths;
+}
+
+void BufferManager::reset_statistics() {
+    pool_stats = BufferPoolStats{0, 0, 0, 0};
+    tier_stats = TierStats{0, 0, 0, 0, 0};
+    pagein_latency = LatencyHistogram();
+    pageout_latency = LatencyHistogram();
+    pagein_batch_latency = LatencyHistogram();
+    pageout_batch_latency = LatencyHistogram();
 }
 
 uint64_t BufferManager::get_total_num_of_pages() const {
-    return static_cast
-    <uint64_t>(pages_per_buffer_file * buffers.size());
+    return placement->get_num_pages();
 }
 
 uint32_t BufferManager::get_mem_alignment() {
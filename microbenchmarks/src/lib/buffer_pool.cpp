@@ -0,0 +1,123 @@
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "buffer_pool.hpp"
+#include "util.hpp"
+
+BufferPool::BufferPool(std::size_t num_frames, std::size_t page_size, uint32_t alignment, EvictionPolicy *policy, std::size_t num_mounts)
+    : num_frames(num_frames), page_size(page_size), memory(alignment, num_frames * page_size), frames(num_frames), page_table(num_frames, num_mounts), policy(policy) {
+    if (num_frames == 0) crash("buffer pool needs at least one frame");
+    for (Frame& f : frames) {
+        f.page_id.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+        f.state.store(0, std::memory_order_relaxed);
+        f.dirty.store(false, std::memory_order_relaxed);
+    }
+    for (std::size_t i = num_frames; i > 0; i--) free_frames.push_back(i - 1);
+}
+
+BufferPool::~BufferPool() {
+    delete policy;
+}
+
+std::size_t BufferPool::pin_resident(uint64_t page_id) {
+    for (;;) {
+        std::size_t frame_id = page_table.lookup(page_id);
+        if (frame_id == INVALID_FRAME_ID) return INVALID_FRAME_ID;
+
+        Frame& f = frames[frame_id];
+        uint32_t state = f.state.load(std::memory_order_acquire);
+        if (state == FRAME_LOCKED) {
+            // someone is loading this page or evicting it, look again once they are done
+            std::this_thread::yield();
+            continue;
+        }
+        if (!f.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) continue;
+        // the frame might have been reused between the lookup and the pin
+        if (f.page_id.load(std::memory_order_acquire) != page_id) {
+            f.state.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+        policy->access(frame_id);
+        return frame_id;
+    }
+}
+
+bool BufferPool::try_lock(std::size_t frame_id) {
+    uint32_t expected = 0;
+    return frames[frame_id].state.compare_exchange_strong(expected, FRAME_LOCKED, std::memory_order_acquire);
+}
+
+std::size_t BufferPool::evict() {
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> guard(eviction_latch);
+            if (!free_frames.empty()) {
+                std::size_t frame_id = free_frames.back();
+                free_frames.pop_back();
+                frames[frame_id].state.store(FRAME_LOCKED, std::memory_order_relaxed);
+                return frame_id;
+            }
+
+            std::size_t frame_id = policy->victim([&](std::size_t id) { return try_lock(id); });
+            if (frame_id != INVALID_FRAME_ID) return frame_id;
+        }
+        // every frame is pinned, e.g. by more threads than there are frames, wait for an unpin
+        std::this_thread::yield();
+    }
+}
+
+bool BufferPool::install(std::size_t frame_id, uint64_t page_id) {
+    Frame& f = frames[frame_id];
+    if (!page_table.insert(page_id, frame_id)) return false;
+
+    // readers of the old page wait on the lock and then notice the new page id
+    uint64_t old_page_id = f.page_id.exchange(page_id, std::memory_order_acq_rel);
+    if (old_page_id != INVALID_PAGE_ID) page_table.erase(old_page_id);
+    f.dirty.store(false, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> guard(eviction_latch);
+    policy->admit(frame_id, page_id);
+    return true;
+}
+
+void BufferPool::loaded(std::size_t frame_id) {
+    frames[frame_id].state.store(1, std::memory_order_release);
+}
+
+void BufferPool::release(std::size_t frame_id) {
+    Frame& f = frames[frame_id];
+    if (f.page_id.load(std::memory_order_relaxed) != INVALID_PAGE_ID) {
+        f.state.store(0, std::memory_order_release);
+        return;
+    }
+    // never admitted, so the policy does not know about it
+    std::lock_guard<std::mutex> guard(eviction_latch);
+    f.state.store(0, std::memory_order_release);
+    free_frames.push_back(frame_id);
+}
+
+void BufferPool::unpin(std::size_t frame_id, bool dirty) {
+    Frame& f = frames[frame_id];
+    if (dirty) f.dirty.store(true, std::memory_order_relaxed);
+    uint32_t state = f.state.fetch_sub(1, std::memory_order_release);
+    if (state == 0 || state == FRAME_LOCKED) crash("buffer pool: unpinning frame " + std::to_string(frame_id) + " which is not pinned");
+}
+
+std::size_t BufferPool::find(uint64_t page_id) const {
+    return page_table.lookup(page_id);
+}
+
+void *BufferPool::data(std::size_t frame_id) const {
+    return static_cast<char*>(*memory) + frame_id * page_size;
+}
+
+Frame& BufferPool::frame(std::size_t frame_id) {
+    return frames[frame_id];
+}
+
+std::size_t BufferPool::get_num_frames() const {
+    return num_frames;
+}
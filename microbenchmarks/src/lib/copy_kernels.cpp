@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <cpuid.h>
+#include <immintrin.h>
+
+#include "copy_kernels.hpp"
+#include "util.hpp"
+
+// one 64 B cache line per call. The line functions carry the target of their instruction set,
+// the kernels calling them are flattened so everything ends up in one function of that target.
+struct Sse41Lines {
+    template<CopyLoad Load, CopyStore Store>
+    __attribute__((target("sse4.1,clwb"))) static inline void line(char *dest, const char *src) {
+        __m128i v[4];
+        for (int i = 0; i < 4; i++) {
+            if constexpr (Load == COPY_LOAD_NT)
+                v[i] = _mm_stream_load_si128(reinterpret_cast<__m128i*>(const_cast<char*>(src) + i * 16));
+            else
+                v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 16));
+        }
+        for (int i = 0; i < 4; i++) {
+            if constexpr (Store == COPY_STORE_NT)
+                _mm_stream_si128(reinterpret_cast<__m128i*>(dest + i * 16), v[i]);
+            else
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 16), v[i]);
+        }
+        if constexpr (Store == COPY_STORE_CLWB) _mm_clwb(dest);
+    }
+};
+
+struct Avx2Lines {
+    template<CopyLoad Load, CopyStore Store>
+    __attribute__((target("avx2,clwb"))) static inline void line(char *dest, const char *src) {
+        __m256i v[2];
+        for (int i = 0; i < 2; i++) {
+            if constexpr (Load == COPY_LOAD_NT)
+                v[i] = _mm256_stream_load_si256(reinterpret_cast<const __m256i*>(src + i * 32));
+            else
+                v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 32));
+        }
+        for (int i = 0; i < 2; i++) {
+            if constexpr (Store == COPY_STORE_NT)
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(dest + i * 32), v[i]);
+            else
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 32), v[i]);
+        }
+        if constexpr (Store == COPY_STORE_CLWB) _mm_clwb(dest);
+    }
+};
+
+struct Avx512Lines {
+    template<CopyLoad Load, CopyStore Store>
+    __attribute__((target("avx512f,clwb"))) static inline void line(char *dest, const char *src) {
+        __m512i v;
+        if constexpr (Load == COPY_LOAD_NT)
+            v = _mm512_stream_load_si512(const_cast<char*>(src));
+        else
+            v = _mm512_loadu_si512(src);
+        if constexpr (Store == COPY_STORE_NT)
+            _mm512_stream_si512(reinterpret_cast<__m512i*>(dest), v);
+        else
+            _mm512_storeu_si512(dest, v);
+        if constexpr (Store == COPY_STORE_CLWB) _mm_clwb(dest);
+    }
+};
+
+// less than a line, stores that bypass or write back the cache get the line flushed
+template<CopyStore Store>
+static inline void copy_partial(char *dest, const char *src, std::size_t len) {
+    std::memcpy(dest, src, len);
+    if constexpr (Store != COPY_STORE_TEMPORAL) _mm_clflush(dest);
+}
+
+// Size is the length known at compile time, 0 if it is only known at runtime
+template<typename Lines, CopyLoad Load, CopyStore Store, std::size_t Size>
+static inline void copy_lines(char *dest, const char *src, std::size_t len) {
+    std::size_t n = Size != 0 ? Size : len;
+    if constexpr (Load == COPY_LOAD_NT || Store != COPY_STORE_TEMPORAL) {
+        // the line-wise part starts at a cache line of the mapped side
+        uintptr_t mapped = reinterpret_cast<uintptr_t>(Load == COPY_LOAD_NT ? src : dest);
+        std::size_t head = std::min(n, static_cast<std::size_t>((64 - mapped % 64) % 64));
+        if (head > 0) {
+            copy_partial<Store>(dest, src, head);
+            dest += head;
+            src += head;
+            n -= head;
+        }
+    }
+    std::size_t whole = n & ~static_cast<std::size_t>(63);
+#pragma GCC unroll 8
+    for (std::size_t i = 0; i < whole; i += 64) Lines::template line<Load, Store>(dest + i, src + i);
+    if (whole != n) copy_partial<Store>(dest + whole, src + whole, n - whole);
+    // orders the weakly ordered stores/write-backs before anything that follows
+    if constexpr (Store != COPY_STORE_TEMPORAL) _mm_sfence();
+}
+
+template<CopyLoad Load, CopyStore Store, std::size_t Size>
+__attribute__((target("sse4.1,clwb"), flatten)) static void copy_sse4_1(char *dest, const char *src, std::size_t len) {
+    copy_lines<Sse41Lines, Load, Store, Size>(dest, src, len);
+}
+
+template<CopyLoad Load, CopyStore Store, std::size_t Size>
+__attribute__((target("avx2,clwb"), flatten)) static void copy_avx2(char *dest, const char *src, std::size_t len) {
+    copy_lines<Avx2Lines, Load, Store, Size>(dest, src, len);
+}
+
+template<CopyLoad Load, CopyStore Store, std::size_t Size>
+__attribute__((target("avx512f,clwb"), flatten)) static void copy_avx512(char *dest, const char *src, std::size_t len) {
+    copy_lines<Avx512Lines, Load, Store, Size>(dest, src, len);
+}
+
+template<CopyLoad Load, CopyStore Store, std::size_t Size>
+static CopyKernel select_kernel(CopyIsa isa) {
+    switch (isa) {
+        case COPY_ISA_AVX512: return copy_avx512<Load, Store, Size>;
+        case COPY_ISA_AVX2: return copy_avx2<Load, Store, Size>;
+        default: return copy_sse4_1<Load, Store, Size>;
+    }
+}
+
+template<CopyLoad Load, CopyStore Store, std::size_t... Shifts>
+static void fill_table(CopyIsa isa, CopyKernel *sized, CopyKernel& generic, std::index_sequence<Shifts...>) {
+    ((sized[Shifts] = select_kernel<Load, Store, static_cast<std::size_t>(1) << (COPY_KERNEL_MIN_PAGE_SHIFT + Shifts)>(isa)), ...);
+    generic = select_kernel<Load, Store, 0>(isa);
+}
+
+CopyKernelTable::CopyKernelTable(CopyIsa isa, CopyLoad load, CopyStore store) {
+    auto sizes = std::make_index_sequence<COPY_KERNEL_SIZES>();
+    if (load == COPY_LOAD_NT && store == COPY_STORE_TEMPORAL)
+        fill_table<COPY_LOAD_NT, COPY_STORE_TEMPORAL>(isa, sized, generic, sizes);
+    else if (load == COPY_LOAD_TEMPORAL && store == COPY_STORE_TEMPORAL)
+        fill_table<COPY_LOAD_TEMPORAL, COPY_STORE_TEMPORAL>(isa, sized, generic, sizes);
+    else if (load == COPY_LOAD_TEMPORAL && store == COPY_STORE_NT)
+        fill_table<COPY_LOAD_TEMPORAL, COPY_STORE_NT>(isa, sized, generic, sizes);
+    else if (load == COPY_LOAD_TEMPORAL && store == COPY_STORE_CLWB)
+        fill_table<COPY_LOAD_TEMPORAL, COPY_STORE_CLWB>(isa, sized, generic, sizes);
+    else
+        crash("no copy kernels for this combination of loads and stores");
+}
+
+CopyKernelTable::CopyKernelTable(CopyKernel kernel) : generic(kernel) {
+    for (CopyKernel& k : sized) k = kernel;
+}
+
+static void copy_memcpy(char *dest, const char *src, std::size_t len) {
+    std::memcpy(dest, src, len);
+}
+
+static void copy_rep_movsb(char *dest, const char *src, std::size_t len) {
+    asm volatile("rep movsb" : "+D" (dest), "+S" (src), "+c" (len) : : "memory");
+}
+
+CopyKernelTable copy_kernels_by_name(const std::string& name) {
+    auto with_isa = [&](CopyIsa isa) {
+        if (isa > detect_copy_isa()) crash("the CPU does not support the " + name + " copy kernel");
+        return isa;
+    };
+    if (name == "MEMCPY") return CopyKernelTable(copy_memcpy);
+    if (name == "REP_MOVSB") return CopyKernelTable(copy_rep_movsb);
+    if (name == "SSE4_1") return CopyKernelTable(with_isa(COPY_ISA_SSE4_1), COPY_LOAD_TEMPORAL, COPY_STORE_TEMPORAL);
+    if (name == "AVX2") return CopyKernelTable(with_isa(COPY_ISA_AVX2), COPY_LOAD_TEMPORAL, COPY_STORE_TEMPORAL);
+    if (name == "AVX512") return CopyKernelTable(with_isa(COPY_ISA_AVX512), COPY_LOAD_TEMPORAL, COPY_STORE_TEMPORAL);
+    if (name == "NT_LOAD") return CopyKernelTable(detect_copy_isa(), COPY_LOAD_NT, COPY_STORE_TEMPORAL);
+    if (name == "NT_STORE") return CopyKernelTable(detect_copy_isa(), COPY_LOAD_TEMPORAL, COPY_STORE_NT);
+    if (name == "CLWB") {
+        if (!cpu_has_clwb()) crash("the CPU does not support clwb");
+        return CopyKernelTable(detect_copy_isa(), COPY_LOAD_TEMPORAL, COPY_STORE_CLWB);
+    }
+    crash("unknown copy kernel " + name);
+    return CopyKernelTable(copy_memcpy);
+}
+
+template<FlushInstruction Instruction>
+static void flush_lines(const char *addr, std::size_t len);
+
+template<>
+void flush_lines<FLUSH_CLFLUSH>(const char *addr, std::size_t len) {
+    for (uintptr_t line = reinterpret_cast<uintptr_t>(addr) & ~static_cast<uintptr_t>(63); line < reinterpret_cast<uintptr_t>(addr) + len; line += 64)
+        _mm_clflush(reinterpret_cast<const void*>(line));
+    _mm_sfence();
+}
+
+template<>
+__attribute__((target("clflushopt"))) void flush_lines<FLUSH_CLFLUSHOPT>(const char *addr, std::size_t len) {
+    for (uintptr_t line = reinterpret_cast<uintptr_t>(addr) & ~static_cast<uintptr_t>(63); line < reinterpret_cast<uintptr_t>(addr) + len; line += 64)
+        _mm_clflushopt(reinterpret_cast<void*>(line));
+    _mm_sfence();
+}
+
+template<>
+__attribute__((target("clwb"))) void flush_lines<FLUSH_CLWB>(const char *addr, std::size_t len) {
+    for (uintptr_t line = reinterpret_cast<uintptr_t>(addr) & ~static_cast<uintptr_t>(63); line < reinterpret_cast<uintptr_t>(addr) + len; line += 64)
+        _mm_clwb(reinterpret_cast<void*>(line));
+    _mm_sfence();
+}
+
+FlushFunction flush_function(FlushInstruction instruction) {
+    switch (instruction) {
+        case FLUSH_CLWB: return flush_lines<FLUSH_CLWB>;
+        case FLUSH_CLFLUSHOPT: return flush_lines<FLUSH_CLFLUSHOPT>;
+        default: return flush_lines<FLUSH_CLFLUSH>;
+    }
+}
+
+FlushInstruction detect_flush_instruction() {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return FLUSH_CLFLUSH;
+    if (ebx & bit_CLWB) return FLUSH_CLWB;
+    if (ebx & bit_CLFLUSHOPT) return FLUSH_CLFLUSHOPT;
+    return FLUSH_CLFLUSH;
+}
+
+const char *flush_instruction_name(FlushInstruction instruction) {
+    switch (instruction) {
+        case FLUSH_CLWB: return "clwb";
+        case FLUSH_CLFLUSHOPT: return "clflushopt";
+        default: return "clflush";
+    }
+}
+
+CopyIsa detect_copy_isa() {
+    static const CopyIsa isa = []() {
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1))
+            crash("the copy kernels need at least SSE4.1");
+        if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX)) return COPY_ISA_SSE4_1;
+        uint32_t xcr0_low, xcr0_high;
+        asm volatile("xgetbv" : "=a" (xcr0_low), "=d" (xcr0_high) : "c" (0));
+        // SSE and AVX state, then additionally opmask and the upper halves of zmm0-31
+        if ((xcr0_low & 0x06) != 0x06) return COPY_ISA_SSE4_1;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return COPY_ISA_SSE4_1;
+        if ((ebx & bit_AVX512F) && (xcr0_low & 0xe6) == 0xe6) return COPY_ISA_AVX512;
+        if (ebx & bit_AVX2) return COPY_ISA_AVX2;
+        return COPY_ISA_SSE4_1;
+    }();
+    return isa;
+}
+
+const char *copy_isa_name(CopyIsa isa) {
+    switch (isa) {
+        case COPY_ISA_AVX512: return "AVX-512";
+        case COPY_ISA_AVX2: return "AVX2";
+        default: return "SSE4.1";
+    }
+}
+
+bool cpu_has_clwb() {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_CLWB);
+}
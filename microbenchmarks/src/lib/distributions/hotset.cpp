@@ -0,0 +1,23 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "distribution.hpp"
+#include "util.hpp"
+
+static uint64_t hot_pages(uint64_t num_pages, double hot_fraction) {
+    return std::min(num_pages, std::max(static_cast<uint64_t>(num_pages * hot_fraction), static_cast<uint64_t>(1)));
+}
+
+HotSetDistribution::HotSetDistribution(uint64_t num_pages, const struct DistributionConfig& config)
+    : hot_operations(config.hot_operations), hot_dis(0.0, 1.0), hot_page_dis(0, hot_pages(num_pages, config.hot_fraction) - 1),
+      cold_page_dis(std::min(hot_pages(num_pages, config.hot_fraction), num_pages - 1), num_pages - 1) {
+    if (config.hot_fraction <= 0.0 || config.hot_fraction > 1.0) crash("invalid hot set fraction " + std::to_string(config.hot_fraction));
+    if (config.hot_operations < 0.0 || config.hot_operations > 1.0) crash("invalid hot set operation share " + std::to_string(config.hot_operations));
+}
+
+uint64_t HotSetDistribution::next(std::mt19937& gen) {
+    if (hot_dis(gen) < hot_operations) return hot_page_dis(gen);
+    return cold_page_dis(gen);
+}
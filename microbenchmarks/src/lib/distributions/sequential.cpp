@@ -0,0 +1,21 @@
+#include <cstdint>
+#include <random>
+
+#include "distribution.hpp"
+#include "util.hpp"
+
+SequentialDistribution::SequentialDistribution(uint64_t num_pages, const struct DistributionConfig& config)
+    : num_pages(num_pages), sequential_run(config.sequential_run), position(0), remaining(0), page_dis(0, num_pages - 1) {
+    if (sequential_run == 0) crash("sequential runs need at least one page");
+}
+
+uint64_t SequentialDistribution::next(std::mt19937& gen) {
+    if (remaining == 0) {
+        position = page_dis(gen);
+        remaining = sequential_run;
+    } else {
+        position = (position + 1) % num_pages;
+    }
+    remaining--;
+    return position;
+}
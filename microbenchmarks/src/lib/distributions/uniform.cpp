@@ -0,0 +1,10 @@
+#include <cstdint>
+#include <random>
+
+#include "distribution.hpp"
+
+UniformDistribution::UniformDistribution(uint64_t num_pages, const struct DistributionConfig&) : page_dis(0, num_pages - 1) {}
+
+uint64_t UniformDistribution::next(std::mt19937& gen) {
+    return page_dis(gen);
+}
@@ -0,0 +1,78 @@
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "distribution.hpp"
+#include "util.hpp"
+
+// zeta(n, theta) of every distribution created so far. Each thread and each sweep repetition creates
+// its own distribution over the same pages, and summing up a multi-GiB buffer takes seconds. A new n
+// continues from the largest smaller one of the same theta, like YCSB does for growing item counts.
+static std::map<std::pair<double, uint64_t>, double> zeta_cache;
+static std::mutex zeta_cache_latch;
+
+static double zeta(uint64_t n, double theta) {
+    std::lock_guard<std::mutex> guard(zeta_cache_latch);
+    uint64_t first = 1;
+    double sum = 0;
+    auto it = zeta_cache.upper_bound({theta, n});
+    if (it != zeta_cache.begin() && (--it)->first.first == theta) {
+        if (it->first.second == n) return it->second;
+        first = it->first.second + 1;
+        sum = it->second;
+    }
+    for (uint64_t i = first; i <= n; i++) sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    zeta_cache[{theta, n}] = sum;
+    return sum;
+}
+
+// FNV-1a over the bytes of value
+static uint64_t fnv_hash(uint64_t value) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < 8; i++) {
+        hash ^= value & 0xff;
+        hash *= 0x100000001b3ULL;
+        value >>= 8;
+    }
+    return hash;
+}
+
+ZipfianDistribution::ZipfianDistribution(uint64_t num_pages, const struct DistributionConfig& config)
+    : num_pages(num_pages), theta(config.zipf_theta), uniform_dis(0.0, 1.0) {
+    if (theta <= 0.0 || theta >= 1.0) crash("zipfian theta has to be in (0, 1), got " + std::to_string(theta));
+    zetan = zeta(num_pages, theta);
+    alpha = 1.0 / (1.0 - theta);
+    eta = (1.0 - std::pow(2.0 / num_pages, 1.0 - theta)) / (1.0 - zeta(2, theta) / zetan);
+}
+
+uint64_t ZipfianDistribution::next(std::mt19937& gen) {
+    double u = uniform_dis(gen);
+    double uz = u * zetan;
+    if (uz < 1.0) return 0;
+    if (uz < 1.0 + std::pow(0.5, theta)) return 1 % num_pages;
+    uint64_t page_id = static_cast<uint64_t>(num_pages * std::pow(eta * u - eta + 1.0, alpha));
+    return page_id < num_pages ? page_id : num_pages - 1;
+}
+
+ScrambledZipfianDistribution::ScrambledZipfianDistribution(uint64_t num_pages, const struct DistributionConfig& config)
+    : num_pages(num_pages), zipf(num_pages, config) {}
+
+uint64_t ScrambledZipfianDistribution::next(std::mt19937& gen) {
+    return fnv_hash(zipf.next(gen)) % num_pages;
+}
+
+LatestDistribution::LatestDistribution(uint64_t num_pages, const struct DistributionConfig& config)
+    : num_pages(num_pages), frontier(num_pages - 1), zipf(num_pages, config) {}
+
+uint64_t LatestDistribution::next(std::mt19937& gen) {
+    return (frontier + num_pages - zipf.next(gen)) % num_pages;
+}
+
+uint64_t LatestDistribution::next_write(std::mt19937&) {
+    frontier = (frontier + 1) % num_pages;
+    return frontier;
+}
@@ -0,0 +1,33 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "buffer_pool.hpp"
+
+ClockEvictionPolicy::ClockEvictionPolicy(std::size_t num_frames) : referenced(num_frames), hand(0) {
+    for (auto& bit : referenced) bit.store(0, std::memory_order_relaxed);
+}
+
+void ClockEvictionPolicy::admit(std::size_t frame_id, uint64_t) {
+    referenced[frame_id].store(1, std::memory_order_relaxed);
+}
+
+void ClockEvictionPolicy::access(std::size_t frame_id) {
+    // only write if needed, so hot pages do not keep bouncing their cache line between cores
+    if (!referenced[frame_id].load(std::memory_order_relaxed))
+        referenced[frame_id].store(1, std::memory_order_relaxed);
+}
+
+std::size_t ClockEvictionPolicy::victim(const std::function<bool(std::size_t)>& try_claim) {
+    // two full rounds: the first one might only clear reference bits
+    for (std::size_t i = 0; i < 2 * referenced.size(); i++) {
+        std::size_t frame_id = hand;
+        hand = (hand + 1) % referenced.size();
+        if (referenced[frame_id].load(std::memory_order_relaxed)) {
+            referenced[frame_id].store(0, std::memory_order_relaxed);
+            continue;
+        }
+        if (try_claim(frame_id)) return frame_id;
+    }
+    return INVALID_FRAME_ID;
+}
@@ -0,0 +1,37 @@
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "buffer_pool.hpp"
+
+LRU2EvictionPolicy::LRU2EvictionPolicy(std::size_t num_frames)
+    : last_access(num_frames, 0), penultimate_access(num_frames, 0), tracked(num_frames, false), clock(0) {}
+
+void LRU2EvictionPolicy::admit(std::size_t frame_id, uint64_t) {
+    std::lock_guard<std::mutex> guard(latch);
+    if (tracked[frame_id])
+        history.erase({penultimate_access[frame_id], last_access[frame_id], frame_id});
+    // only seen once so far: infinite backward 2-distance, so it goes first (ties broken by LRU)
+    penultimate_access[frame_id] = 0;
+    last_access[frame_id] = ++clock;
+    history.insert({penultimate_access[frame_id], last_access[frame_id], frame_id});
+    tracked[frame_id] = true;
+}
+
+void LRU2EvictionPolicy::access(std::size_t frame_id) {
+    std::unique_lock<std::mutex> guard(latch, std::try_to_lock);
+    if (!guard.owns_lock() || !tracked[frame_id]) return;
+    history.erase({penultimate_access[frame_id], last_access[frame_id], frame_id});
+    penultimate_access[frame_id] = last_access[frame_id];
+    last_access[frame_id] = ++clock;
+    history.insert({penultimate_access[frame_id], last_access[frame_id], frame_id});
+}
+
+std::size_t LRU2EvictionPolicy::victim(const std::function<bool(std::size_t)>& try_claim) {
+    std::lock_guard<std::mutex> guard(latch);
+    for (const HistoryKey& key : history) {
+        std::size_t frame_id = std::get<2>(key);
+        if (try_claim(frame_id)) return frame_id;
+    }
+    return INVALID_FRAME_ID;
+}
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "buffer_pool.hpp"
+
+TwoQEvictionPolicy::TwoQEvictionPolicy(std::size_t num_frames)
+    : queue_of(num_frames, NONE), position(num_frames), page_of(num_frames, INVALID_PAGE_ID),
+      kin(std::max(num_frames / 4, static_cast<std::size_t>(1))), kout(std::max(num_frames / 2, static_cast<std::size_t>(1))) {}
+
+void TwoQEvictionPolicy::admit(std::size_t frame_id, uint64_t page_id) {
+    std::lock_guard<std::mutex> guard(latch);
+    // the page only leaves the frame now that the new one is installed, pages evicted from A1in are remembered
+    if (queue_of[frame_id] == A1IN && page_of[frame_id] != page_id) remember(page_of[frame_id]);
+    if (queue_of[frame_id] == A1IN) a1in.erase(position[frame_id]);
+    else if (queue_of[frame_id] == AM) am.erase(position[frame_id]);
+
+    // pages that come back while still remembered in A1out are considered hot
+    auto ghost = a1out_index.find(page_id);
+    if (ghost != a1out_index.end()) {
+        a1out.erase(ghost->second);
+        a1out_index.erase(ghost);
+        am.push_front(frame_id);
+        position[frame_id] = am.begin();
+        queue_of[frame_id] = AM;
+    } else {
+        a1in.push_front(frame_id);
+        position[frame_id] = a1in.begin();
+        queue_of[frame_id] = A1IN;
+    }
+    page_of[frame_id] = page_id;
+}
+
+void TwoQEvictionPolicy::access(std::size_t frame_id) {
+    std::unique_lock<std::mutex> guard(latch, std::try_to_lock);
+    if (!guard.owns_lock()) return;
+    // hits in A1in are correlated references and do not promote
+    if (queue_of[frame_id] == AM) am.splice(am.begin(), am, position[frame_id]);
+}
+
+std::size_t TwoQEvictionPolicy::victim_from(std::list<std::size_t>& queue, const std::function<bool(std::size_t)>& try_claim) {
+    for (auto it = queue.rbegin(); it != queue.rend(); ++it) {
+        if (try_claim(*it)) return *it;
+    }
+    return INVALID_FRAME_ID;
+}
+
+void TwoQEvictionPolicy::remember(uint64_t page_id) {
+    a1out.push_front(page_id);
+    a1out_index[page_id] = a1out.begin();
+    if (a1out.size() > kout) {
+        a1out_index.erase(a1out.back());
+        a1out.pop_back();
+    }
+}
+
+std::size_t TwoQEvictionPolicy::victim(const std::function<bool(std::size_t)>& try_claim) {
+    std::lock_guard<std::mutex> guard(latch);
+    std::size_t frame_id = INVALID_FRAME_ID;
+    if (a1in.size() > kin || am.empty()) {
+        frame_id = victim_from(a1in, try_claim);
+        if (frame_id != INVALID_FRAME_ID) return frame_id;
+    }
+    frame_id = victim_from(am, try_claim);
+    if (frame_id != INVALID_FRAME_ID) return frame_id;
+
+    // everything in Am is pinned, fall back to A1in
+    return victim_from(a1in, try_claim);
+}
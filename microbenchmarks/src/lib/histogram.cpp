@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "histogram.hpp"
+
+LatencyHistogram::LatencyHistogram() : buckets(HISTOGRAM_BUCKETS, 0), count(0), sum(0), max(0), min(UINT64_MAX) {}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (std::size_t i = 0; i < buckets.size(); i++) buckets[i] += other.buckets[i];
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+    min = std::min(min, other.min);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(std::size_t bucket) {
+    if (bucket < HISTOGRAM_SUB_BUCKETS) return bucket;
+    std::size_t shift = (bucket - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_SUB_BUCKETS;
+    uint64_t sub_bucket = HISTOGRAM_SUB_BUCKETS + (bucket - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_SUB_BUCKETS;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (count == 0) return 0;
+    uint64_t rank = std::max(static_cast<uint64_t>(std::ceil(p / 100.0 * count)), static_cast<uint64_t>(1));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(bucket_upper_bound(i), max);
+    }
+    return max;
+}
+
+uint64_t LatencyHistogram::get_count() const {
+    return count;
+}
+
+uint64_t LatencyHistogram::get_max() const {
+    return max;
+}
+
+uint64_t LatencyHistogram::get_min() const {
+    return count == 0 ? 0 : min;
+}
+
+double LatencyHistogram::get_mean() const {
+    return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+}
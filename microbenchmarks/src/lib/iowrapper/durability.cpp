@@ -0,0 +1,93 @@
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "histogram.hpp"
+#include "iowrapper.hpp"
+#include "util.hpp"
+
+DurabilityPolicy::DurabilityPolicy() : DurabilityPolicy(DurabilityConfig{DURABILITY_FDATASYNC, 1, 0}) {}
+
+DurabilityPolicy::DurabilityPolicy(const struct DurabilityConfig& config) : config(config), pending(0), last_sync_ns(now_ns()) {
+    if (this->config.sync_every == 0) this->config.sync_every = 1;
+#ifndef RWF_DSYNC
+    if (config.mode == DURABILITY_RWF_DSYNC) crash("RWF_DSYNC is not available on this system");
+#endif
+#ifndef __linux
+    if (config.mode == DURABILITY_SYNC_FILE_RANGE) crash("sync_file_range is only available on linux");
+#endif
+}
+
+int DurabilityPolicy::open_flags() const {
+    return config.mode == DURABILITY_O_DSYNC ? O_DSYNC : 0;
+}
+
+int DurabilityPolicy::write_flags() const {
+#ifdef RWF_DSYNC
+    if (config.mode == DURABILITY_RWF_DSYNC) return RWF_DSYNC;
+#endif
+    return 0;
+}
+
+bool DurabilityPolicy::needs_flush() const {
+    return config.mode != DURABILITY_NONE;
+}
+
+void DurabilityPolicy::written(int fd, std::size_t position, std::size_t len, std::size_t writes, const std::string& filename) {
+    switch (config.mode) {
+        case DURABILITY_FDATASYNC:
+            sync(fd, filename);
+            return;
+        case DURABILITY_SYNC_FILE_RANGE:
+#ifdef __linux
+            // only starts the writeback, the window waits for it
+            if (sync_file_range(fd, position, len, SYNC_FILE_RANGE_WRITE) != 0) {
+                perror("sync_file_range");
+                crash(std::string("could not start writeback of file ") + filename);
+            }
+#endif
+            break;
+        case DURABILITY_GROUP:
+            break;
+        default:
+            // nothing to do or already durable once the write returns
+            return;
+    }
+    pending += writes;
+    if (pending >= config.sync_every || (config.sync_interval_us > 0 && now_ns() - last_sync_ns >= config.sync_interval_us * 1000))
+        sync(fd, filename);
+}
+
+void DurabilityPolicy::finish(int fd, const std::string& filename) {
+    if (pending > 0) sync(fd, filename);
+}
+
+void DurabilityPolicy::sync(int fd, const std::string& filename) {
+    pending = 0;
+    last_sync_ns = now_ns();
+#ifdef __linux
+    if (config.mode == DURABILITY_SYNC_FILE_RANGE) {
+        // waits for the data pages only, neither metadata nor the device cache are flushed
+        if (sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER) != 0) {
+            perror("sync_file_range");
+            crash(std::string("could not sync file ") + filename);
+        }
+        return;
+    }
+#endif
+    int sync_res;
+#if _POSIX_SYNCHRONIZED_IO > 0
+        sync_res = fdatasync(fd);
+#else
+        sync_res = fsync(fd);
+#endif
+    if (sync_res != 0) {
+#if _POSIX_SYNCHRONIZED_IO > 0
+        perror("fdatasync");
+#else
+        perror("fsync");
+#endif
+        crash(std::string("could not sync file ") + filename);
+    }
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -17,3 +18,56 @@ uintmax_t IOWrapper::get_filesize() const {
     std::filesystem::path p{get_filename()};
     return std::filesystem::file_size(p);
 }
+
+int IOWrapper::submit_read(void *dest, std::size_t position, std::size_t len, uint64_t tag) {
+    completed.push_back({tag, false, read(dest, position, len)});
+    return 0;
+}
+
+int IOWrapper::submit_write(void *src, std::size_t position, std::size_t len, uint64_t tag) {
+    completed.push_back({tag, true, write(src, position, len)});
+    return 0;
+}
+
+std::size_t IOWrapper::poll(std::vector<IOCompletion>& completions) {
+    std::size_t num_completed = completed.size();
+    completions.insert(completions.end(), completed.begin(), completed.end());
+    completed.clear();
+    return num_completed;
+}
+
+std::size_t IOWrapper::wait(std::vector<IOCompletion>& completions, std::size_t) {
+    // everything already completed during submission
+    return poll(completions);
+}
+
+std::size_t IOWrapper::inflight() const {
+    return completed.size();
+}
+
+int IOWrapper::read_batch(std::vector<IORequest>& batch) {
+    for (const IORequest& r : batch)
+        if (read(r.buf, r.position, r.len) != 0) return -1;
+    return 0;
+}
+
+int IOWrapper::write_batch(std::vector<IORequest>& batch) {
+    for (const IORequest& r : batch)
+        if (write(r.buf, r.position, r.len) != 0) return -1;
+    return 0;
+}
+
+void IOWrapper::for_each_run(std::vector<IORequest>& batch, std::size_t max_run, const std::function<void(std::size_t, std::size_t)>& run) {
+    std::sort(batch.begin(), batch.end(), [](const IORequest& a, const IORequest& b) { return a.position < b.position; });
+    std::size_t first = 0;
+    while (first < batch.size()) {
+        std::size_t last = first + 1;
+        std::size_t end = batch[first].position + batch[first].len;
+        while (last < batch.size() && last - first < max_run && batch[last].position == end) {
+            end += batch[last].len;
+            last++;
+        }
+        run(first, last);
+        first = last;
+    }
+}
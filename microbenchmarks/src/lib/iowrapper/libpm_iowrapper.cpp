@@ -6,10 +6,26 @@
 #include <unistd.h>
 #include <cstring>
 
+#include "copy_kernels.hpp"
 #include "util.hpp"
 #include "iowrapper.hpp"
 
-LibPMIOWrapper::LibPMIOWrapper(struct IOWrapperConfig& config) {
+// PMEM2 variants are pmem2_memcpy with a flag, every other kernel name is a generic copy kernel
+static bool pmem2_memcpy_flags_of(const std::string& name, unsigned int *flags) {
+    if (name.empty() || name == "PMEM2") *flags = 0;
+    else if (name == "PMEM2_NONTEMPORAL") *flags = PMEM2_F_MEM_NONTEMPORAL;
+    else if (name == "PMEM2_TEMPORAL") *flags = PMEM2_F_MEM_TEMPORAL;
+    else if (name == "PMEM2_WC") *flags = PMEM2_F_MEM_WC;
+    else return false;
+    return true;
+}
+
+LibPMIOWrapper::LibPMIOWrapper(struct IOWrapperConfig& config)
+ : read_kernels(copy_kernels_by_name(config.read_kernel != nullptr && config.read_kernel[0] != '\0' ? config.read_kernel : "MEMCPY")),
+   write_kernels(copy_kernels_by_name("MEMCPY")) {
+    std::string write_kernel = config.write_kernel != nullptr ? config.write_kernel : "";
+    use_pmem2_memcpy = pmem2_memcpy_flags_of(write_kernel, &pmem2_memcpy_flags);
+    if (!use_pmem2_memcpy) write_kernels = copy_kernels_by_name(write_kernel);
 
     bufferFilename = std::string(config.directory) + BUFFER_FILE_BASENAME + std::string(config.file_suffix);
     fd = open(bufferFilename.c_str(), open_flags(), 0666);
@@ -66,6 +82,8 @@ LibPMIOWrapper::LibPMIOWrapper(struct IOWrapperConfig& config) {
     map_addr = pmem2_map_get_address(pmmap);
     pmpersist_fn = pmem2_get_persist_fn(pmmap);
     pmmemcpy_fn = pmem2_get_memcpy_fn(pmmap);
+    pmflush_fn = pmem2_get_flush_fn(pmmap);
+    pmdrain_fn = pmem2_get_drain_fn(pmmap);
 }
 
 LibPMIOWrapper::~LibPMIOWrapper() {
@@ -89,12 +107,32 @@ LibPMIOWrapper::~LibPMIOWrapper() {
 }
 
 int LibPMIOWrapper::read(void *dest, std::size_t position, std::size_t len) {
-    std::memcpy(dest, ((char*)map_addr) + position, len);
+    read_kernels.get(len)(static_cast<char*>(dest), static_cast<char*>(map_addr) + position, len);
     return 0;
 }
 
 int LibPMIOWrapper::write(void *src, std::size_t position, std::size_t len) {
-    pmmemcpy_fn(((char*)map_addr) + position, src, len, 0);
+    char *dest = static_cast<char*>(map_addr) + position;
+    if (use_pmem2_memcpy) {
+        pmmemcpy_fn(dest, src, len, pmem2_memcpy_flags);
+    } else {
+        write_kernels.get(len)(dest, static_cast<const char*>(src), len);
+        pmpersist_fn(dest, len);
+    }
+    return 0;
+}
+
+int LibPMIOWrapper::write_batch(std::vector<IORequest>& batch) {
+    for (const IORequest& r : batch) {
+        char *dest = static_cast<char*>(map_addr) + r.position;
+        if (use_pmem2_memcpy) {
+            pmmemcpy_fn(dest, r.buf, r.len, pmem2_memcpy_flags | PMEM2_F_MEM_NODRAIN);
+        } else {
+            write_kernels.get(r.len)(dest, static_cast<const char*>(r.buf), r.len);
+            pmflush_fn(dest, r.len);
+        }
+    }
+    pmdrain_fn();
     return 0;
 }
 
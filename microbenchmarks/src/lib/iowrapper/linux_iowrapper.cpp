@@ -1,15 +1,18 @@
 #define _XOPEN_SOURCE
 
+#include <climits>
 #include <string>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/uio.h>
 
 #include "util.hpp"
 #include "iowrapper.hpp"
 
 LinuxIOWrapper::LinuxIOWrapper(struct IOWrapperConfig& config) {
     bufferFilename = std::string(config.directory) + BUFFER_FILE_BASENAME + std::string(config.file_suffix);
-    fd = open(bufferFilename.c_str(), open_flags(), 0666);
+    durability = DurabilityPolicy(config.durability);
+    fd = open(bufferFilename.c_str(), open_flags() | durability.open_flags(), 0666);
     if (fd == -1) {
         perror("open");       
         crash(std::string("could not open buffer file ") + bufferFilename);
@@ -40,7 +43,8 @@ LinuxIOWrapper::LinuxIOWrapper(struct IOWrapperConfig& config) {
 
 DirectLinuxIOWrapper::DirectLinuxIOWrapper(struct IOWrapperConfig& config) {
     bufferFilename = std::string(config.directory) + BUFFER_FILE_BASENAME + std::string(config.file_suffix);
-    fd = open(bufferFilename.c_str(), open_flags(), 0666);
+    durability = DurabilityPolicy(config.durability);
+    fd = open(bufferFilename.c_str(), open_flags() | durability.open_flags(), 0666);
     if (fd == -1) {
         perror("open");       
         crash(std::string("could not open buffer file ") + bufferFilename);
@@ -90,6 +94,7 @@ void DirectLinuxIOWrapper::handle_write_error() {
 }
 
 LinuxIOWrapper::~LinuxIOWrapper() {
+    durability.finish(fd, bufferFilename);
     if (close(fd) != 0) {
         perror("close");
         crash(std::string("could not close buffer file ") + bufferFilename);
@@ -109,6 +114,17 @@ int LinuxIOWrapper::read(void *dest, std::size_t position, std::size_t len) {
 }
 
 int LinuxIOWrapper::write(void *src, std::size_t position, std::size_t len) {
+    if (durability.write_flags() != 0) {
+#ifdef RWF_DSYNC
+        struct iovec iov{src, len};
+        if (pwritev2(fd, &iov, 1, position, durability.write_flags()) == -1) {
+            perror("pwritev2");
+            handle_write_error();
+            crash(std::string("could not write in file ") + bufferFilename + std::string(" (fd ") + std::to_string(fd) + std::string(", len ") + std::to_string(len) + std::string(") to position ") + std::to_string(position));
+        }
+#endif
+        return 0;
+    }
     if (lseek(fd, position, SEEK_SET) == -1) {
         perror("lseek");
         crash(std::string("could not seek in file ") + bufferFilename + std::string(" to position ") + std::to_string(position));
@@ -118,20 +134,52 @@ int LinuxIOWrapper::write(void *src, std::size_t position, std::size_t len) {
         handle_write_error();
         crash(std::string("could not write in file ") + bufferFilename + std::string(" (fd ") + std::to_string(fd) + std::string(", len ") + std::to_string(len) + std::string(") to position ") + std::to_string(position));
     }
-    int sync_res;
-#if _POSIX_SYNCHRONIZED_IO > 0
-        sync_res = fdatasync(fd);
-#else
-        sync_res = fsync(fd);
-#endif
-    if (sync_res != 0) {
-#if _POSIX_SYNCHRONIZED_IO > 0
-        perror("fdatasync");
-#else
-        perror("fsync");
+    durability.written(fd, position, len, 1, bufferFilename);
+    return 0;
+}
+
+int LinuxIOWrapper::read_batch(std::vector<IORequest>& batch) {
+    for_each_run(batch, IOV_MAX, [&](std::size_t first, std::size_t last) {
+        iovecs.clear();
+        std::size_t len = 0;
+        for (std::size_t i = first; i < last; i++) {
+            iovecs.push_back({batch[i].buf, batch[i].len});
+            len += batch[i].len;
+        }
+        if (preadv(fd, iovecs.data(), static_cast<int>(iovecs.size()), batch[first].position) != static_cast<ssize_t>(len)) {
+            perror("preadv");
+            crash(std::string("could not read in file ") + bufferFilename + std::string(" from position ") + std::to_string(batch[first].position));
+        }
+    });
+    return 0;
+}
+
+int LinuxIOWrapper::write_batch(std::vector<IORequest>& batch) {
+    if (batch.empty()) return 0;
+    for_each_run(batch, IOV_MAX, [&](std::size_t first, std::size_t last) {
+        iovecs.clear();
+        std::size_t len = 0;
+        for (std::size_t i = first; i < last; i++) {
+            iovecs.push_back({batch[i].buf, batch[i].len});
+            len += batch[i].len;
+        }
+        ssize_t res;
+#ifdef RWF_DSYNC
+        if (durability.write_flags() != 0)
+            res = pwritev2(fd, iovecs.data(), static_cast<int>(iovecs.size()), batch[first].position, durability.write_flags());
+        else
 #endif
-        crash(std::string("could not sync file ") + bufferFilename);
-    }
+            res = pwritev(fd, iovecs.data(), static_cast<int>(iovecs.size()), batch[first].position);
+        if (res != static_cast<ssize_t>(len)) {
+            perror("pwritev");
+            handle_write_error();
+            crash(std::string("could not write in file ") + bufferFilename + std::string(" (fd ") + std::to_string(fd) + std::string(", len ") + std::to_string(len) + std::string(") to position ") + std::to_string(batch[first].position));
+        }
+    });
+    // synced at most once, but counts every page towards the group. Sorted, so it spans from the
+    // first to the last request
+    std::size_t end = batch.back().position + batch.back().len;
+    durability.written(fd, batch.front().position, end - batch.front().position, batch.size(), bufferFilename);
     return 0;
 }
 
@@ -3,15 +3,22 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <immintrin.h>
 
 #ifdef __linux
 #include <linux/version.h>
 #endif
 
+#include "copy_kernels.hpp"
 #include "util.hpp"
 #include "iowrapper.hpp"
 
-MmapIOWrapper::MmapIOWrapper(struct IOWrapperConfig& config) {
+// the kernel the config names, or memcpy if it does not name one
+static CopyKernelTable kernels_of(const char *name) {
+    return copy_kernels_by_name(name != nullptr && name[0] != '\0' ? name : "MEMCPY");
+}
+
+MmapIOWrapper::MmapIOWrapper(struct IOWrapperConfig& config) : read_kernels(kernels_of(config.read_kernel)), write_kernels(kernels_of(config.write_kernel)) {
     bufferFilename = std::string(config.directory) + BUFFER_FILE_BASENAME + std::string(config.file_suffix);
     fd = open(bufferFilename.c_str(), open_flags(), 0666);
     mempagesize = getpagesize();
@@ -112,12 +119,12 @@ MmapIOWrapper::~MmapIOWrapper() {
 }
 
 int MmapIOWrapper::read(void *dest, std::size_t position, std::size_t len) {
-    std::memcpy(dest, map_addr + position, len);
+    read_kernels.get(len)(static_cast<char*>(dest), map_addr + position, len);
     return 0;
 }
 
 int MmapIOWrapper::write(void *src, std::size_t position, std::size_t len) {
-    std::memcpy(map_addr + position, src, len);
+    write_kernels.get(len)(map_addr + position, static_cast<const char*>(src), len);
 
     uintptr_t sync_addr = (uintptr_t)map_addr + position;
     sync_addr &= ~(static_cast<uintptr_t>(mempagesize) - 1);
@@ -131,6 +138,54 @@ int MmapIOWrapper::write(void *src, std::size_t position, std::size_t len) {
     return 0;
 }
 
+int MmapIOWrapper::write_batch(std::vector<IORequest>& batch) {
+    for (const IORequest& r : batch) write_kernels.get(r.len)(map_addr + r.position, static_cast<const char*>(r.buf), r.len);
+    for_each_run(batch, batch.size(), [&](std::size_t first, std::size_t last) {
+        std::size_t position = batch[first].position;
+        std::size_t len = batch[last - 1].position + batch[last - 1].len - position;
+        uintptr_t sync_addr = (uintptr_t)map_addr + position;
+        sync_addr &= ~(static_cast<uintptr_t>(mempagesize) - 1);
+        std::size_t sync_len = len + ((uintptr_t)map_addr + position - sync_addr);
+        if (msync((void*)sync_addr, sync_len, MS_SYNC) != 0) {
+            perror("msync");
+            crash(std::string("could not sync file ") + bufferFilename);
+        }
+    });
+    return 0;
+}
+
+FlushingMmapIOWrapper::FlushingMmapIOWrapper(struct IOWrapperConfig& config) : MmapIOWrapper(config), flush(flush_function(detect_flush_instruction())) {
+    if (!config.use_map_sync) bmlog::warning("flushing cache lines without MAP_SYNC does not persist page cache or file metadata");
+}
+
+int FlushingMmapIOWrapper::write(void *src, std::size_t position, std::size_t len) {
+    write_kernels.get(len)(map_addr + position, static_cast<const char*>(src), len);
+    flush(map_addr + position, len);
+    return 0;
+}
+
+int FlushingMmapIOWrapper::write_batch(std::vector<IORequest>& batch) {
+    // the flush fences every page itself, there is nothing to share
+    return IOWrapper::write_batch(batch);
+}
+
+EadrMmapIOWrapper::EadrMmapIOWrapper(struct IOWrapperConfig& config) : MmapIOWrapper(config) {
+    if (!config.use_map_sync) bmlog::warning("eADR only persists without msync if the file is mapped with MAP_SYNC");
+}
+
+int EadrMmapIOWrapper::write(void *src, std::size_t position, std::size_t len) {
+    write_kernels.get(len)(map_addr + position, static_cast<const char*>(src), len);
+    // the stores are persistent once globally visible
+    _mm_sfence();
+    return 0;
+}
+
+int EadrMmapIOWrapper::write_batch(std::vector<IORequest>& batch) {
+    for (const IORequest& r : batch) write_kernels.get(r.len)(map_addr + r.position, static_cast<const char*>(r.buf), r.len);
+    _mm_sfence();
+    return 0;
+}
+
 const char* MmapIOWrapper::get_filename() const {
     return bufferFilename.c_str();
 }
@@ -10,13 +10,27 @@
 
 STDIOWrapper::STDIOWrapper(struct IOWrapperConfig& config) {
     bufferFilename = std::string(config.directory) + BUFFER_FILE_BASENAME + std::string(config.file_suffix);
-    if ((f = std::fopen(bufferFilename.c_str(), "r+")) == NULL) {
-        perror("fopen");
-        crash("IOWrapper:fopen failed");
-    }
-    if ((fd = fileno(f)) == -1) {
-        perror("fileno");
-        crash("IOWrapper: fileno for some reason crashed. AP is not happy.");
+    durability = DurabilityPolicy(config.durability);
+    if (durability.write_flags() != 0) crash("STD writes through fwrite, use the LINUX engine for RWF_DSYNC");
+    if (durability.open_flags() != 0) {
+        // fopen cannot set O_DSYNC
+        if ((fd = open(bufferFilename.c_str(), O_RDWR | durability.open_flags())) == -1) {
+            perror("open");
+            crash(std::string("could not open buffer file ") + bufferFilename);
+        }
+        if ((f = fdopen(fd, "r+")) == NULL) {
+            perror("fdopen");
+            crash("IOWrapper:fdopen failed");
+        }
+    } else {
+        if ((f = std::fopen(bufferFilename.c_str(), "r+")) == NULL) {
+            perror("fopen");
+            crash("IOWrapper:fopen failed");
+        }
+        if ((fd = fileno(f)) == -1) {
+            perror("fileno");
+            crash("IOWrapper: fileno for some reason crashed. AP is not happy.");
+        }
     }
 #ifdef __linux
     if (config.use_fadvise) {
@@ -43,6 +57,11 @@ STDIOWrapper::STDIOWrapper(struct IOWrapperConfig& config) {
 }
 
 STDIOWrapper::~STDIOWrapper() {
+    if (std::fflush(f) == EOF) {
+        perror("fflush");
+        crash(std::string("could not flush buffer file ") + bufferFilename);
+    }
+    durability.finish(fd, bufferFilename);
     if(std::fclose(f) == EOF) {
         perror("fclose");
         crash(std::string("could not close buffer file ") + bufferFilename);
@@ -73,20 +92,12 @@ int STDIOWrapper::write(void *src, std::size_t position, std::size_t len) {
         crash(std::string("could not write to file ") + bufferFilename);
     }
 
-    int sync_res;
-#if _POSIX_SYNCHRONIZED_IO > 0
-        sync_res = fdatasync(fd);
-#else
-        sync_res = fsync(fd);
-#endif
-    if (sync_res != 0) {
-#if _POSIX_SYNCHRONIZED_IO > 0
-        perror("fdatasync");
-#else
-        perror("fsync");
-#endif
-        crash(std::string("could not sync file ") + bufferFilename);
+    // the sync has to see the data, not just the stdio buffer
+    if (durability.needs_flush() && std::fflush(f) == EOF) {
+        perror("fflush");
+        crash(std::string("could not flush file ") + bufferFilename);
     }
+    durability.written(fd, position, len, 1, bufferFilename);
 
     return 0;
 }
@@ -0,0 +1,325 @@
+
+#ifdef __linux
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <liburing.h>
+
+#include "util.hpp"
+#include "iowrapper.hpp"
+
+#define URING_SQPOLL_IDLE_MS 2000
+
+// the lowest user_data bit tells the data transfer apart from the linked fdatasync,
+// the remaining bits hold the index into requests
+#define URING_TAG_SYNC 1
+
+IoUringIOWrapper::IoUringIOWrapper(struct IOWrapperConfig& config) {
+    setup(config);
+}
+
+DirectIoUringIOWrapper::DirectIoUringIOWrapper(struct IOWrapperConfig& config) {
+    setup(config);
+}
+
+void IoUringIOWrapper::setup(struct IOWrapperConfig& config) {
+    bufferFilename = std::string(config.directory) + BUFFER_FILE_BASENAME + std::string(config.file_suffix);
+    fd = open(bufferFilename.c_str(), open_flags(), 0666);
+    if (fd == -1) {
+        perror("open");
+        crash(std::string("could not open buffer file ") + bufferFilename);
+    }
+
+    if (config.use_fadvise) {
+        if (posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0) {
+            perror("posix_fadvise");
+            bmlog::warning("posix_fadvise did not succeed");
+        }
+    }
+
+    if (config.fadv_sequential) {
+        if (posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL) != 0) {
+            perror("posix_fadvise");
+            bmlog::warning("posix_fadvise did not succeed");
+        }
+    }
+
+    if (config.fadv_random) {
+        if (posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM) != 0) {
+            perror("posix_fadvise");
+            bmlog::warning("posix_fadvise did not succeed");
+        }
+    }
+
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    if (config.uring_sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = URING_SQPOLL_IDLE_MS;
+    }
+
+    // every write occupies two submission entries (write + fdatasync)
+    unsigned int queue_depth = std::max(config.queue_depth, 1u);
+    requests.resize(queue_depth);
+    for (unsigned int i = queue_depth; i > 0; i--) free_requests.push_back(i - 1);
+    unsubmitted = 0;
+    blocking_pending = 0;
+
+    int res;
+    if ((res = io_uring_queue_init_params(2 * queue_depth, &ring, &params)) < 0) {
+        errno = -res;
+        perror("io_uring_queue_init_params");
+        crash(std::string("could not set up io_uring for ") + bufferFilename);
+    }
+
+    // we only ever talk to one file, so it always is fixed file 0
+    if ((res = io_uring_register_files(&ring, &fd, 1)) < 0) {
+        errno = -res;
+        perror("io_uring_register_files");
+        crash(std::string("could not register buffer file ") + bufferFilename + " with io_uring");
+    }
+}
+
+IoUringIOWrapper::~IoUringIOWrapper() {
+    io_uring_queue_exit(&ring);
+    if (close(fd) != 0) {
+        perror("close");
+        crash(std::string("could not close buffer file ") + bufferFilename);
+    }
+}
+
+int IoUringIOWrapper::open_flags() {
+    return O_RDWR | O_CREAT;
+}
+
+int DirectIoUringIOWrapper::open_flags() {
+    return O_RDWR | O_CREAT | O_DIRECT;
+}
+
+void IoUringIOWrapper::handle_write_error() { }
+
+void DirectIoUringIOWrapper::handle_write_error() {
+    bmlog::error("you are using O_DIRECT and write failed. check if you are using aligned memory!");
+}
+
+void IoUringIOWrapper::register_buffers(const std::vector<struct iovec>& buffers) {
+    if (!fixed_buffers.empty()) {
+        io_uring_unregister_buffers(&ring);
+        fixed_buffers.clear();
+    }
+    if (buffers.empty()) return;
+
+    int res = io_uring_register_buffers(&ring, buffers.data(), buffers.size());
+    if (res < 0) {
+        errno = -res;
+        perror("io_uring_register_buffers");
+        bmlog::warning("could not register fixed buffers (check RLIMIT_MEMLOCK), falling back to unregistered buffers");
+        return;
+    }
+    fixed_buffers = buffers;
+}
+
+int IoUringIOWrapper::fixed_buffer_index(void *addr, std::size_t len) const {
+    uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+    for (std::size_t i = 0; i < fixed_buffers.size(); i++) {
+        uintptr_t buf_start = reinterpret_cast<uintptr_t>(fixed_buffers[i].iov_base);
+        if (start >= buf_start && start + len <= buf_start + fixed_buffers[i].iov_len)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+unsigned int IoUringIOWrapper::acquire_request() {
+    // queue full: push out what we have and wait for a slot, keeping the completion for the next poll
+    while (free_requests.empty()) reap(true);
+    unsigned int request_id = free_requests.back();
+    free_requests.pop_back();
+    return request_id;
+}
+
+void IoUringIOWrapper::prepare(unsigned int request_id, void *buf) {
+    Request& request = requests[request_id];
+    int buf_index = fixed_buffer_index(buf, request.len);
+    uint64_t user_data = static_cast<uint64_t>(request_id) << 1;
+
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+    if (request.is_write && request.synced) {
+        if (buf_index >= 0)
+            io_uring_prep_write_fixed(sqe, 0, buf, request.len, request.position, buf_index);
+        else
+            io_uring_prep_write(sqe, 0, buf, request.len, request.position);
+        io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE | IOSQE_IO_LINK);
+        io_uring_sqe_set_data64(sqe, user_data);
+
+        // same durability as LinuxIOWrapper, but linked so both go out with a single submission
+        sqe = io_uring_get_sqe(&ring);
+        io_uring_prep_fsync(sqe, 0, IORING_FSYNC_DATASYNC);
+        io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+        io_uring_sqe_set_data64(sqe, user_data | URING_TAG_SYNC);
+    } else if (request.is_write) {
+        // part of a batch, synced once all of it is written
+        if (buf_index >= 0)
+            io_uring_prep_write_fixed(sqe, 0, buf, request.len, request.position, buf_index);
+        else
+            io_uring_prep_write(sqe, 0, buf, request.len, request.position);
+        io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+        io_uring_sqe_set_data64(sqe, user_data);
+    } else {
+        if (buf_index >= 0)
+            io_uring_prep_read_fixed(sqe, 0, buf, request.len, request.position, buf_index);
+        else
+            io_uring_prep_read(sqe, 0, buf, request.len, request.position);
+        io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+        io_uring_sqe_set_data64(sqe, user_data);
+    }
+    unsubmitted++;
+}
+
+void IoUringIOWrapper::prepare_sync(unsigned int request_id) {
+    // drained, so it only starts once everything submitted before it completed
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+    io_uring_prep_fsync(sqe, 0, IORING_FSYNC_DATASYNC);
+    io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE | IOSQE_IO_DRAIN);
+    io_uring_sqe_set_data64(sqe, (static_cast<uint64_t>(request_id) << 1) | URING_TAG_SYNC);
+    unsubmitted++;
+}
+
+void IoUringIOWrapper::flush_submissions() {
+    if (unsubmitted == 0) return;
+    int res;
+    if ((res = io_uring_submit(&ring)) < 0) {
+        errno = -res;
+        perror("io_uring_submit");
+        crash(std::string("could not submit to io_uring of file ") + bufferFilename);
+    }
+    unsubmitted = 0;
+}
+
+bool IoUringIOWrapper::reap(bool block) {
+    flush_submissions();
+
+    struct io_uring_cqe *cqe;
+    int res = block ? io_uring_wait_cqe(&ring, &cqe) : io_uring_peek_cqe(&ring, &cqe);
+    if (res == -EAGAIN && !block) return false;
+    if (res < 0) {
+        errno = -res;
+        perror("io_uring_wait_cqe");
+        crash(std::string("could not wait for completion on file ") + bufferFilename);
+    }
+
+    uint64_t user_data = io_uring_cqe_get_data64(cqe);
+    bool is_sync = user_data & URING_TAG_SYNC;
+    unsigned int request_id = static_cast<unsigned int>(user_data >> 1);
+    res = cqe->res;
+    io_uring_cqe_seen(&ring, cqe);
+
+    Request& request = requests[request_id];
+    if (is_sync && res != 0) {
+        errno = -res;
+        perror("fdatasync");
+        crash(std::string("could not sync file ") + bufferFilename);
+    } else if (!is_sync && res != static_cast<int>(request.len)) {
+        const char *op = request.is_write ? "write" : "read";
+        if (res < 0) errno = -res;
+        perror(op);
+        if (request.is_write) handle_write_error();
+        crash(std::string("could not ") + op + " in file " + bufferFilename + std::string(" (len ") + std::to_string(request.len) + std::string(", got ") + std::to_string(res) + std::string(") at position ") + std::to_string(request.position));
+    }
+
+    // a write is only done once its fdatasync is
+    if (request.is_write && request.synced && !is_sync) return true;
+
+    if (request.blocking)
+        blocking_pending--;
+    else
+        completed.push_back({request.tag, request.is_write, 0});
+    free_requests.push_back(request_id);
+    return true;
+}
+
+int IoUringIOWrapper::submit_read(void *dest, std::size_t position, std::size_t len, uint64_t tag) {
+    unsigned int request_id = acquire_request();
+    requests[request_id] = {tag, position, len, false, false, false};
+    prepare(request_id, dest);
+    return 0;
+}
+
+int IoUringIOWrapper::submit_write(void *src, std::size_t position, std::size_t len, uint64_t tag) {
+    unsigned int request_id = acquire_request();
+    requests[request_id] = {tag, position, len, true, false, true};
+    prepare(request_id, src);
+    return 0;
+}
+
+std::size_t IoUringIOWrapper::poll(std::vector<IOCompletion>& completions) {
+    while (reap(false));
+    return IOWrapper::poll(completions);
+}
+
+std::size_t IoUringIOWrapper::wait(std::vector<IOCompletion>& completions, std::size_t min_completions) {
+    while (completed.size() < min_completions && free_requests.size() < requests.size()) reap(true);
+    return poll(completions);
+}
+
+std::size_t IoUringIOWrapper::inflight() const {
+    return requests.size() - free_requests.size() + completed.size();
+}
+
+int IoUringIOWrapper::read(void *dest, std::size_t position, std::size_t len) {
+    unsigned int request_id = acquire_request();
+    requests[request_id] = {0, position, len, false, true, false};
+    blocking_pending++;
+    prepare(request_id, dest);
+    wait_blocking();
+    return 0;
+}
+
+int IoUringIOWrapper::write(void *src, std::size_t position, std::size_t len) {
+    unsigned int request_id = acquire_request();
+    requests[request_id] = {0, position, len, true, true, true};
+    blocking_pending++;
+    prepare(request_id, src);
+    wait_blocking();
+    return 0;
+}
+
+void IoUringIOWrapper::wait_blocking() {
+    while (blocking_pending > 0) reap(true);
+}
+
+int IoUringIOWrapper::read_batch(std::vector<IORequest>& batch) {
+    for (const IORequest& r : batch) {
+        unsigned int request_id = acquire_request();
+        requests[request_id] = {0, r.position, r.len, false, true, false};
+        blocking_pending++;
+        prepare(request_id, r.buf);
+    }
+    wait_blocking();
+    return 0;
+}
+
+int IoUringIOWrapper::write_batch(std::vector<IORequest>& batch) {
+    if (batch.empty()) return 0;
+    for (const IORequest& r : batch) {
+        unsigned int request_id = acquire_request();
+        requests[request_id] = {0, r.position, r.len, true, true, false};
+        blocking_pending++;
+        prepare(request_id, r.buf);
+    }
+    unsigned int request_id = acquire_request();
+    requests[request_id] = {0, 0, 0, true, true, true};
+    blocking_pending++;
+    prepare_sync(request_id);
+    wait_blocking();
+    return 0;
+}
+
+const char* IoUringIOWrapper::get_filename() const {
+    return bufferFilename.c_str();
+}
+
+#endif
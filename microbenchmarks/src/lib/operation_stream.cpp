@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "operation_stream.hpp"
+#include "util.hpp"
+
+static_assert(sizeof(Operation) == 16, "operation streams are persisted, keep their layout stable");
+static_assert(sizeof(OperationStreamHeader) % sizeof(Operation) == 0, "operations have to stay aligned in the mapping");
+
+OperationStream::OperationStream(const struct OperationStreamHeader& header)
+    : header(header), generated(header.num_operations), map_addr(nullptr), map_length(0), operations(generated.data()) {
+    this->header.magic = OPERATION_STREAM_MAGIC;
+}
+
+OperationStream::OperationStream(const std::string& filename) : generated(), map_addr(nullptr), map_length(0), operations(nullptr) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        perror("open");
+        crash("could not open operation stream " + filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("fstat");
+        crash("could not stat operation stream " + filename);
+    }
+    map_length = st.st_size;
+    if (map_length < sizeof(header)) crash("operation stream " + filename + " is truncated");
+
+    // populate, so replaying does not page fault in the timed loop
+    map_addr = mmap(NULL, map_length, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    if (map_addr == MAP_FAILED) {
+        perror("mmap");
+        crash("could not map operation stream " + filename);
+    }
+    close(fd);
+
+    std::memcpy(&header, map_addr, sizeof(header));
+    if (header.magic != OPERATION_STREAM_MAGIC) crash(filename + " is not an operation stream");
+    if (map_length < sizeof(header) + header.num_operations * sizeof(Operation)) crash("operation stream " + filename + " is truncated");
+    operations = reinterpret_cast<Operation*>(static_cast<char*>(map_addr) + sizeof(header));
+}
+
+OperationStream::~OperationStream() {
+    if (map_addr != nullptr && munmap(map_addr, map_length) != 0) {
+        perror("munmap");
+        bmlog::error("could not unmap operation stream");
+    }
+}
+
+void OperationStream::save(const std::string& filename) const {
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd == -1) {
+        perror("open");
+        crash("could not create operation stream " + filename);
+    }
+
+    const char *parts[] = {reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(operations)};
+    std::size_t lengths[] = {sizeof(header), header.num_operations * sizeof(Operation)};
+    for (int i = 0; i < 2; i++) {
+        std::size_t written = 0;
+        while (written < lengths[i]) {
+            ssize_t res = write(fd, parts[i] + written, lengths[i] - written);
+            if (res <= 0) {
+                perror("write");
+                crash("could not write operation stream " + filename);
+            }
+            written += res;
+        }
+    }
+
+    if (close(fd) != 0) {
+        perror("close");
+        crash("could not close operation stream " + filename);
+    }
+}
+
+const struct OperationStreamHeader& OperationStream::get_header() const {
+    return header;
+}
+
+Operation *OperationStream::data() {
+    return operations;
+}
@@ -0,0 +1,191 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "buffer_pool.hpp"
+#include "page_table.hpp"
+
+#define PAGE_TABLE_PARTITIONS_PER_MOUNT 64
+#define SLOT_EMPTY UINT64_MAX
+#define SLOT_TOMBSTONE (UINT64_MAX - 1)
+
+uint64_t OptimisticLatch::read_begin() const {
+    uint64_t v;
+    while ((v = version.load(std::memory_order_acquire)) & 1) std::this_thread::yield();
+    return v;
+}
+
+bool OptimisticLatch::read_validate(uint64_t v) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version.load(std::memory_order_relaxed) == v;
+}
+
+void OptimisticLatch::lock() {
+    uint64_t v = version.load(std::memory_order_relaxed);
+    for (;;) {
+        if (!(v & 1) && version.compare_exchange_weak(v, v + 1, std::memory_order_acquire)) break;
+        if (v & 1) {
+            std::this_thread::yield();
+            v = version.load(std::memory_order_relaxed);
+        }
+    }
+    // slot stores must not become visible before the version is odd
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void OptimisticLatch::unlock() {
+    version.fetch_add(1, std::memory_order_release);
+}
+
+PageTable::Table::Table(std::size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {
+    for (std::size_t i = 0; i < capacity; i++) {
+        slots[i].key.store(SLOT_EMPTY, std::memory_order_relaxed);
+        slots[i].value.store(INVALID_FRAME_ID, std::memory_order_relaxed);
+    }
+}
+
+PageTable::PageTable(std::size_t expected_entries, std::size_t num_mounts)
+    : num_mounts(num_mounts), partitions_per_mount(PAGE_TABLE_PARTITIONS_PER_MOUNT), partitions(new Partition[num_mounts * PAGE_TABLE_PARTITIONS_PER_MOUNT]) {
+    std::size_t num_partitions = num_mounts * partitions_per_mount;
+    // keep the load factor at 50% if pages are spread evenly
+    std::size_t capacity = 16;
+    while (capacity < 2 * expected_entries / num_partitions) capacity <<= 1;
+    for (std::size_t i = 0; i < num_partitions; i++) {
+        Partition& p = partitions[i];
+        p.tables.push_back(std::make_unique<Table>(capacity));
+        p.table.store(p.tables.back().get(), std::memory_order_release);
+        p.used = 0;
+        p.tombstones = 0;
+    }
+}
+
+uint64_t PageTable::hash(uint64_t key) {
+    // murmur3 finalizer
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+PageTable::Partition& PageTable::partition_of(uint64_t page_id) const {
+    std::size_t mount = page_id % num_mounts;
+    std::size_t sub = hash(page_id / num_mounts) % partitions_per_mount;
+    return partitions[mount * partitions_per_mount + sub];
+}
+
+std::size_t PageTable::lookup(uint64_t page_id) const {
+    Partition& p = partition_of(page_id);
+    uint64_t h = hash(page_id);
+    for (;;) {
+        uint64_t version = p.latch.read_begin();
+        const Table *t = p.table.load(std::memory_order_acquire);
+        std::size_t result = INVALID_FRAME_ID;
+        for (std::size_t i = 0; i <= t->mask; i++) {
+            const Slot& slot = t->slots[(h + i) & t->mask];
+            uint64_t key = slot.key.load(std::memory_order_relaxed);
+            if (key == SLOT_EMPTY) break;
+            if (key == page_id) {
+                result = slot.value.load(std::memory_order_relaxed);
+                break;
+            }
+        }
+        if (p.latch.read_validate(version)) return result;
+    }
+}
+
+bool PageTable::insert(uint64_t page_id, std::size_t frame_id) {
+    Partition& p = partition_of(page_id);
+    uint64_t h = hash(page_id);
+    p.latch.lock();
+    if ((p.used + p.tombstones + 1) * 4 > (p.table.load(std::memory_order_relaxed)->mask + 1) * 3) grow(p);
+
+    Table *t = p.table.load(std::memory_order_relaxed);
+    Slot *target = nullptr;
+    for (std::size_t i = 0; i <= t->mask; i++) {
+        Slot& slot = t->slots[(h + i) & t->mask];
+        uint64_t key = slot.key.load(std::memory_order_relaxed);
+        if (key == page_id) {
+            p.latch.unlock();
+            return false;
+        }
+        if (key == SLOT_TOMBSTONE && target == nullptr) target = &slot;
+        if (key == SLOT_EMPTY) {
+            if (target == nullptr) target = &slot;
+            break;
+        }
+    }
+
+    if (target->key.load(std::memory_order_relaxed) == SLOT_TOMBSTONE) p.tombstones--;
+    target->value.store(frame_id, std::memory_order_relaxed);
+    target->key.store(page_id, std::memory_order_relaxed);
+    p.used++;
+    p.latch.unlock();
+    return true;
+}
+
+void PageTable::erase(uint64_t page_id) {
+    Partition& p = partition_of(page_id);
+    uint64_t h = hash(page_id);
+    p.latch.lock();
+    Table *t = p.table.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i <= t->mask; i++) {
+        Slot& slot = t->slots[(h + i) & t->mask];
+        uint64_t key = slot.key.load(std::memory_order_relaxed);
+        if (key == SLOT_EMPTY) break;
+        if (key == page_id) {
+            slot.key.store(SLOT_TOMBSTONE, std::memory_order_relaxed);
+            p.used--;
+            p.tombstones++;
+            break;
+        }
+    }
+    p.latch.unlock();
+}
+
+void PageTable::grow(Partition& p) {
+    // called with the latch held. Rebuilding drops the tombstones, the capacity only doubles if
+    // the live entries alone fill half of the table.
+    Table *old_table = p.table.load(std::memory_order_relaxed);
+    std::size_t capacity = old_table->mask + 1;
+    if (p.used * 2 < capacity) {
+        // same capacity: rehash in place, readers see the version change and retry
+        std::vector<std::pair<uint64_t, uint64_t>> entries;
+        entries.reserve(p.used);
+        for (std::size_t i = 0; i <= old_table->mask; i++) {
+            uint64_t key = old_table->slots[i].key.load(std::memory_order_relaxed);
+            if (key != SLOT_EMPTY && key != SLOT_TOMBSTONE) entries.emplace_back(key, old_table->slots[i].value.load(std::memory_order_relaxed));
+            old_table->slots[i].key.store(SLOT_EMPTY, std::memory_order_relaxed);
+        }
+        for (auto& entry : entries) place(*old_table, entry.first, entry.second);
+        p.tombstones = 0;
+        return;
+    }
+
+    // readers may still probe the old table, it is kept until the page table is destroyed. Only
+    // doubling tables are kept, so together they stay smaller than the current one.
+    auto new_table = std::make_unique<Table>(capacity << 1);
+    for (std::size_t i = 0; i <= old_table->mask; i++) {
+        uint64_t key = old_table->slots[i].key.load(std::memory_order_relaxed);
+        if (key == SLOT_EMPTY || key == SLOT_TOMBSTONE) continue;
+        place(*new_table, key, old_table->slots[i].value.load(std::memory_order_relaxed));
+    }
+    p.tombstones = 0;
+    p.table.store(new_table.get(), std::memory_order_release);
+    p.tables.push_back(std::move(new_table));
+}
+
+void PageTable::place(Table& t, uint64_t key, uint64_t value) {
+    uint64_t h = hash(key);
+    for (std::size_t j = 0; j <= t.mask; j++) {
+        Slot& slot = t.slots[(h + j) & t.mask];
+        if (slot.key.load(std::memory_order_relaxed) != SLOT_EMPTY) continue;
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.key.store(key, std::memory_order_relaxed);
+        return;
+    }
+}
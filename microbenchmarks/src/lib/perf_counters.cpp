@@ -0,0 +1,112 @@
+#ifdef __linux
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#include "perf_counters.hpp"
+#include "util.hpp"
+
+struct PerfEvent {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+};
+
+#define PERF_CACHE_EVENT(cache, op, result) ((cache) | ((op) << 8) | ((result) << 16))
+
+static const PerfEvent perf_events[] = {
+    {"Cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"Instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    // the generic cache miss event is the last level cache on x86
+    {"LLC Misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"dTLB Load Misses", PERF_TYPE_HW_CACHE, PERF_CACHE_EVENT(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"Minor Page Faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN},
+    {"Major Page Faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ},
+    {"Context Switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+};
+
+// every thread opens its own counters, only tell once what is missing
+static std::atomic<bool> reported_missing{false};
+
+static int perf_event_open(struct perf_event_attr *attr) {
+    return static_cast<int>(syscall(__NR_perf_event_open, attr, 0, -1, -1, 0));
+}
+
+PerfCounters::PerfCounters(PerfCounterScope scope) {
+    std::string missing;
+    for (const PerfEvent& event : perf_events) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.disabled = 1;
+        attr.inherit = scope == PERF_COUNTERS_PROCESS ? 1 : 0;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = perf_event_open(&attr);
+        if (fd == -1 && (errno == EACCES || errno == EPERM)) {
+            // perf_event_paranoid > 1 only allows counting user space
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = perf_event_open(&attr);
+        }
+        if (fd == -1) {
+            missing += std::string(missing.empty() ? "" : ", ") + event.name + " (" + std::strerror(errno) + ")";
+            continue;
+        }
+        fds.push_back(fd);
+        counts.emplace_back(event.name, 0);
+    }
+    if (!missing.empty() && !reported_missing.exchange(true))
+        bmlog::warning(("could not open perf counters: " + missing).c_str());
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds) close(fd);
+}
+
+void PerfCounters::start() {
+    for (int fd : fds) {
+        if (ioctl(fd, PERF_EVENT_IOC_RESET, 0) != 0 || ioctl(fd, PERF_EVENT_IOC_ENABLE, 0) != 0) {
+            perror("ioctl");
+            bmlog::warning("could not start perf counter");
+        }
+    }
+}
+
+void PerfCounters::stop() {
+    for (int fd : fds) {
+        if (ioctl(fd, PERF_EVENT_IOC_DISABLE, 0) != 0) {
+            perror("ioctl");
+            bmlog::warning("could not stop perf counter");
+        }
+    }
+    for (std::size_t i = 0; i < fds.size(); i++) {
+        // value, time enabled, time running
+        uint64_t values[3];
+        if (read(fds[i], values, sizeof(values)) != sizeof(values)) {
+            perror("read");
+            bmlog::warning("could not read perf counter");
+            continue;
+        }
+        if (values[2] == 0)
+            counts[i].second = 0;
+        else if (values[2] < values[1])
+            counts[i].second = static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+        else
+            counts[i].second = values[0];
+    }
+}
+
+const std::vector<std::pair<std::string, uint64_t>>& PerfCounters::get_counts() const {
+    return counts;
+}
+
+#endif
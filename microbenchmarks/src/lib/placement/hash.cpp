@@ -0,0 +1,47 @@
+#include <cstdint>
+
+#include "placement.hpp"
+
+#define HASH_PLACEMENT_ROUNDS 4
+
+static uint64_t mix(uint64_t key) {
+    // murmur3 finalizer
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+HashPlacement::HashPlacement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig&)
+    : num_mounts(num_mounts), num_pages(pages_per_mount * num_mounts) {
+    // the network permutes [0, 2^(2 * half_bits)), which is less than four times the buffer
+    unsigned int bits = num_pages > 1 ? 64 - __builtin_clzll(num_pages - 1) : 1;
+    half_bits = (bits + 1) / 2;
+    half_mask = (static_cast<uint64_t>(1) << half_bits) - 1;
+}
+
+uint64_t HashPlacement::permute(uint64_t page_id) const {
+    do {
+        uint64_t left = page_id >> half_bits;
+        uint64_t right = page_id & half_mask;
+        for (uint64_t round = 0; round < HASH_PLACEMENT_ROUNDS; round++) {
+            uint64_t next = left ^ (mix(right + round) & half_mask);
+            left = right;
+            right = next;
+        }
+        page_id = (left << half_bits) | right;
+    } while (page_id >= num_pages);
+    return page_id;
+}
+
+void HashPlacement::place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const {
+    uint64_t slot = permute(page_id);
+    *mount = slot % num_mounts;
+    *internal_id = slot / num_mounts;
+}
+
+uint64_t HashPlacement::get_num_pages() const {
+    return num_pages;
+}
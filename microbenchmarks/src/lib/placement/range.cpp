@@ -0,0 +1,15 @@
+#include <cstdint>
+
+#include "placement.hpp"
+
+RangePlacement::RangePlacement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig&)
+    : num_mounts(num_mounts), pages_per_mount(pages_per_mount) {}
+
+void RangePlacement::place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const {
+    *mount = page_id / pages_per_mount;
+    *internal_id = page_id % pages_per_mount;
+}
+
+uint64_t RangePlacement::get_num_pages() const {
+    return pages_per_mount * num_mounts;
+}
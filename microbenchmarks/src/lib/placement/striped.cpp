@@ -0,0 +1,28 @@
+#include <cstdint>
+#include <string>
+
+#include "placement.hpp"
+#include "util.hpp"
+
+StripedPlacement::StripedPlacement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig& config)
+    : num_mounts(num_mounts), pages_per_mount(pages_per_mount), stripe_pages(config.stripe_pages) {
+    if (stripe_pages == 0) crash("invalid stripe unit of 0 pages");
+    full_stripes = pages_per_mount / stripe_pages;
+    striped_pages = full_stripes * stripe_pages * num_mounts;
+}
+
+void StripedPlacement::place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const {
+    if (page_id < striped_pages) {
+        uint64_t stripe = page_id / stripe_pages;
+        *mount = stripe % num_mounts;
+        *internal_id = (stripe / num_mounts) * stripe_pages + page_id % stripe_pages;
+        return;
+    }
+    uint64_t rest = page_id - striped_pages;
+    *mount = rest % num_mounts;
+    *internal_id = full_stripes * stripe_pages + rest / num_mounts;
+}
+
+uint64_t StripedPlacement::get_num_pages() const {
+    return pages_per_mount * num_mounts;
+}
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <string>
+
+#include "placement.hpp"
+#include "util.hpp"
+
+// the largest weight gets this many stripe units per round, the others at least one
+#define WEIGHTED_PLACEMENT_RESOLUTION 16
+
+WeightedPlacement::WeightedPlacement(std::size_t num_mounts, uint64_t pages_per_mount, const struct PlacementConfig& config) : stripe_pages(config.stripe_pages) {
+    if (stripe_pages == 0) crash("invalid stripe unit of 0 pages");
+    if (config.weights.size() != num_mounts)
+        crash("weighted placement needs one weight per mount, got " + std::to_string(config.weights.size()) + " for " + std::to_string(num_mounts));
+    double max_weight = *std::max_element(config.weights.begin(), config.weights.end());
+    if (max_weight <= 0 || std::any_of(config.weights.begin(), config.weights.end(), [](double w) { return w <= 0; }))
+        crash("placement weights have to be positive");
+
+    uint64_t divisor = 0;
+    for (double w : config.weights) {
+        units.push_back(std::max(static_cast<uint64_t>(std::llround(w / max_weight * WEIGHTED_PLACEMENT_RESOLUTION)), static_cast<uint64_t>(1)));
+        divisor = std::gcd(divisor, units.back());
+    }
+    for (auto& u : units) u /= divisor;
+    uint64_t round_units = std::accumulate(units.begin(), units.end(), static_cast<uint64_t>(0));
+    round_pages = round_units * stripe_pages;
+
+    // smooth weighted round robin: every unit goes to the mount that is furthest behind its share
+    std::vector<int64_t> credit(num_mounts, 0);
+    std::vector<uint64_t> assigned(num_mounts, 0);
+    for (uint64_t u = 0; u < round_units; u++) {
+        for (std::size_t m = 0; m < num_mounts; m++) credit[m] += units[m];
+        std::size_t mount = std::max_element(credit.begin(), credit.end()) - credit.begin();
+        credit[mount] -= round_units;
+        unit_mount.push_back(mount);
+        unit_index.push_back(assigned[mount]++);
+    }
+
+    uint64_t rounds = UINT64_MAX;
+    for (std::size_t m = 0; m < num_mounts; m++) rounds = std::min(rounds, pages_per_mount / (units[m] * stripe_pages));
+    if (rounds == 0) crash("the buffer files are too small for a single round of weighted stripes");
+    num_pages = rounds * round_pages;
+}
+
+void WeightedPlacement::place(uint64_t page_id, std::size_t *mount, uint64_t *internal_id) const {
+    uint64_t round = page_id / round_pages;
+    uint64_t unit = (page_id % round_pages) / stripe_pages;
+    *mount = unit_mount[unit];
+    *internal_id = (round * units[*mount] + unit_index[unit]) * stripe_pages + page_id % stripe_pages;
+}
+
+uint64_t WeightedPlacement::get_num_pages() const {
+    return num_pages;
+}
@@ -0,0 +1,175 @@
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "pmem_tier.hpp"
+#include "util.hpp"
+
+// bits of an access count, a page's count is zero at the latest once the CLOCK passed it this often
+#define TIER_COUNT_BITS 8
+#define TIER_MAX_COUNT ((1 << TIER_COUNT_BITS) - 1)
+
+PMemTier::PMemTier(IOWrapper *wrapper, std::size_t num_slots, std::size_t page_size, uint64_t num_pages, std::size_t num_mounts, const struct TierConfig& config)
+    : wrapper(wrapper), num_slots(num_slots), page_size(page_size), num_pages(num_pages), config(config), access_counts(new std::atomic<uint8_t>[num_pages]), promotions_since_aging(0), slots(num_slots), page_table(num_slots, num_mounts), hand(0) {
+    if (num_slots == 0) crash("the PMem tier needs at least one slot");
+    if (num_slots * page_size > wrapper->get_filesize()) crash("the PMem tier file is too small for " + std::to_string(num_slots) + " pages of " + std::to_string(page_size) + " B");
+    if (config.promote_after > TIER_MAX_COUNT) crash("pages can be promoted after at most " + std::to_string(TIER_MAX_COUNT) + " accesses");
+    for (uint64_t i = 0; i < num_pages; i++) access_counts[i].store(0, std::memory_order_relaxed);
+    for (Frame& s : slots) {
+        s.page_id.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+        s.state.store(0, std::memory_order_relaxed);
+        s.dirty.store(false, std::memory_order_relaxed);
+    }
+    for (std::size_t i = num_slots; i > 0; i--) free_slots.push_back(i - 1);
+}
+
+void PMemTier::touch(uint64_t page_id) {
+    // racing increments may get lost, the counts only need to tell hot from cold pages
+    uint8_t count = access_counts[page_id].load(std::memory_order_relaxed);
+    if (count < TIER_MAX_COUNT) access_counts[page_id].store(count + 1, std::memory_order_relaxed);
+}
+
+bool PMemTier::is_hot(uint64_t page_id) const {
+    return access_counts[page_id].load(std::memory_order_relaxed) >= config.promote_after;
+}
+
+bool PMemTier::contains(uint64_t page_id) const {
+    return page_table.lookup(page_id) != INVALID_FRAME_ID;
+}
+
+std::size_t PMemTier::pin_resident(uint64_t page_id) {
+    for (;;) {
+        std::size_t slot_id = page_table.lookup(page_id);
+        if (slot_id == INVALID_FRAME_ID) return INVALID_FRAME_ID;
+
+        Frame& s = slots[slot_id];
+        uint32_t state = s.state.load(std::memory_order_acquire);
+        if (state == FRAME_LOCKED) {
+            // someone is writing this slot or demoting its page, look again once they are done
+            std::this_thread::yield();
+            continue;
+        }
+        if (!s.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) continue;
+        // the slot might have been reused between the lookup and the pin
+        if (s.page_id.load(std::memory_order_acquire) != page_id) {
+            s.state.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+        return slot_id;
+    }
+}
+
+std::size_t PMemTier::lock_resident(uint64_t page_id) {
+    for (;;) {
+        std::size_t slot_id = page_table.lookup(page_id);
+        if (slot_id == INVALID_FRAME_ID) return INVALID_FRAME_ID;
+
+        if (!try_lock(slot_id)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (slots[slot_id].page_id.load(std::memory_order_acquire) != page_id) {
+            slots[slot_id].state.store(0, std::memory_order_release);
+            continue;
+        }
+        return slot_id;
+    }
+}
+
+bool PMemTier::try_lock(std::size_t slot_id) {
+    uint32_t expected = 0;
+    return slots[slot_id].state.compare_exchange_strong(expected, FRAME_LOCKED, std::memory_order_acquire);
+}
+
+std::size_t PMemTier::demote() {
+    std::lock_guard<std::mutex> guard(demotion_latch);
+    if (!free_slots.empty()) {
+        std::size_t slot_id = free_slots.back();
+        free_slots.pop_back();
+        slots[slot_id].state.store(FRAME_LOCKED, std::memory_order_relaxed);
+        return slot_id;
+    }
+
+    // pages accessed since the hand last passed them get their count halved and stay, after
+    // TIER_COUNT_BITS + 1 rounds every slot that is not in use has been a candidate
+    for (std::size_t step = 0; step < num_slots * (TIER_COUNT_BITS + 1); step++) {
+        std::size_t slot_id = hand;
+        hand = (hand + 1) % num_slots;
+        Frame& s = slots[slot_id];
+        if (s.state.load(std::memory_order_relaxed) != 0) continue;
+        uint64_t page_id = s.page_id.load(std::memory_order_relaxed);
+        uint8_t count = access_counts[page_id].load(std::memory_order_relaxed);
+        if (count > 0) {
+            access_counts[page_id].store(count / 2, std::memory_order_relaxed);
+            continue;
+        }
+        if (try_lock(slot_id)) return slot_id;
+    }
+    return INVALID_FRAME_ID;
+}
+
+bool PMemTier::install(std::size_t slot_id, uint64_t page_id) {
+    Frame& s = slots[slot_id];
+    if (!page_table.insert(page_id, slot_id)) return false;
+
+    // readers of the old page wait on the lock and then notice the new page id
+    uint64_t old_page_id = s.page_id.exchange(page_id, std::memory_order_acq_rel);
+    if (old_page_id != INVALID_PAGE_ID) page_table.erase(old_page_id);
+    s.dirty.store(false, std::memory_order_relaxed);
+    // the thread completing a turnover of the tier ages the counts, racing touches may get lost
+    if (promotions_since_aging.fetch_add(1, std::memory_order_relaxed) + 1 == num_slots) {
+        promotions_since_aging.store(0, std::memory_order_relaxed);
+        age();
+    }
+    return true;
+}
+
+void PMemTier::age() {
+    for (uint64_t i = 0; i < num_pages; i++) {
+        uint8_t count = access_counts[i].load(std::memory_order_relaxed);
+        if (count > 0) access_counts[i].store(count / 2, std::memory_order_relaxed);
+    }
+}
+
+void PMemTier::release(std::size_t slot_id, bool dirty) {
+    Frame& s = slots[slot_id];
+    if (dirty) s.dirty.store(true, std::memory_order_relaxed);
+    if (s.page_id.load(std::memory_order_relaxed) != INVALID_PAGE_ID) {
+        s.state.store(0, std::memory_order_release);
+        return;
+    }
+    std::lock_guard<std::mutex> guard(demotion_latch);
+    s.state.store(0, std::memory_order_release);
+    free_slots.push_back(slot_id);
+}
+
+void PMemTier::unpin(std::size_t slot_id) {
+    uint32_t state = slots[slot_id].state.fetch_sub(1, std::memory_order_release);
+    if (state == 0 || state == FRAME_LOCKED) crash("PMem tier: unpinning slot " + std::to_string(slot_id) + " which is not pinned");
+}
+
+int PMemTier::read(std::size_t slot_id, void *dest) {
+    return wrapper->read(dest, slot_id * page_size, page_size);
+}
+
+int PMemTier::write(std::size_t slot_id, void *src) {
+    return wrapper->write(src, slot_id * page_size, page_size);
+}
+
+Frame& PMemTier::slot(std::size_t slot_id) {
+    return slots[slot_id];
+}
+
+std::size_t PMemTier::get_num_slots() const {
+    return num_slots;
+}
+
+uint32_t PMemTier::get_alignment() {
+    return wrapper->get_alignment();
+}
+
+const struct TierConfig& PMemTier::get_config() const {
+    return config;
+}
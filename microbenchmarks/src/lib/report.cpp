@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+
+#include "report.hpp"
+#include "util.hpp"
+
+const std::string& Report::add_entry(const std::string& section, ReportEntry entry) {
+    auto it = std::find_if(sections.begin(), sections.end(), [&](const auto& s) { return s.first == section; });
+    if (it == sections.end()) {
+        sections.emplace_back(section, std::vector<ReportEntry>());
+        it = sections.end() - 1;
+    }
+    // options can be reported more than once, e.g. after being adjusted
+    auto existing = std::find_if(it->second.begin(), it->second.end(), [&](const auto& e) { return e.name == entry.name; });
+    if (existing != it->second.end()) {
+        *existing = entry;
+        return existing->value;
+    }
+    it->second.push_back(entry);
+    return it->second.back().value;
+}
+
+std::vector<ReportEntry> Report::get(const std::string& section) const {
+    auto it = std::find_if(sections.begin(), sections.end(), [&](const auto& s) { return s.first == section; });
+    return it == sections.end() ? std::vector<ReportEntry>() : it->second;
+}
+
+const std::string& Report::add(const std::string& section, const std::string& name, const std::string& value) {
+    return add_entry(section, {name, value, true});
+}
+
+const std::string& Report::add(const std::string& section, const std::string& name, const char *value) {
+    return add_entry(section, {name, std::string(value), true});
+}
+
+const std::string& Report::add(const std::string& section, const std::string& name, bool value) {
+    return add_entry(section, {name, value ? "1" : "0", false});
+}
+
+void Report::add_mount(const std::vector<ReportEntry>& mount) {
+    mounts.push_back(mount);
+}
+
+std::string Report::key(const std::string& name) {
+    std::string key;
+    for (char c : name) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        } else if (!key.empty() && key.back() != '_') {
+            key += '_';
+        }
+    }
+    while (!key.empty() && key.back() == '_') key.pop_back();
+    return key;
+}
+
+static std::string json_string(const std::string& value) {
+    std::string escaped = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    escaped += buf;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped + "\"";
+}
+
+static std::string json_value(const ReportEntry& entry) {
+    if (entry.is_string) return json_string(entry.value);
+    // std::to_string gives "inf"/"nan" for doubles that JSON has no literal for
+    if (entry.value.find_first_of("in") != std::string::npos) return "null";
+    return entry.value;
+}
+
+static std::string csv_field(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) return value;
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void Report::write(const std::string& filename) const {
+    std::string extension = ".csv";
+    if (filename.size() >= extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0)
+        write_csv(filename);
+    else
+        write_json(filename);
+}
+
+void Report::write_json(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out) crash("could not open result file " + filename);
+
+    out << "{";
+    for (std::size_t s = 0; s < sections.size(); s++) {
+        out << (s == 0 ? "\n" : ",\n") << "  " << json_string(sections[s].first) << ": {";
+        const std::vector<ReportEntry>& entries = sections[s].second;
+        for (std::size_t e = 0; e < entries.size(); e++) {
+            out << (e == 0 ? "\n" : ",\n") << "    " << json_string(key(entries[e].name)) << ": " << json_value(entries[e]);
+        }
+        out << "\n  }";
+    }
+    out << (sections.empty() ? "\n" : ",\n") << "  \"mounts\": [";
+    for (std::size_t m = 0; m < mounts.size(); m++) {
+        out << (m == 0 ? "\n" : ",\n") << "    {";
+        for (std::size_t e = 0; e < mounts[m].size(); e++) {
+            out << (e == 0 ? "" : ", ") << json_string(key(mounts[m][e].name)) << ": " << json_value(mounts[m][e]);
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+    if (!out) crash("could not write result file " + filename);
+}
+
+void Report::write_csv(const std::string& filename) const {
+    std::vector<std::string> header;
+    std::vector<std::string> row;
+    for (const auto& section : sections) {
+        for (const ReportEntry& entry : section.second) {
+            header.push_back(section.first + "." + key(entry.name));
+            row.push_back(csv_field(entry.value));
+        }
+    }
+    for (std::size_t m = 0; m < mounts.size(); m++) {
+        for (const ReportEntry& entry : mounts[m]) {
+            header.push_back("mounts." + std::to_string(m) + "." + key(entry.name));
+            row.push_back(csv_field(entry.value));
+        }
+    }
+
+    auto join = [](const std::vector<std::string>& fields) {
+        std::string line;
+        for (std::size_t i = 0; i < fields.size(); i++) line += (i == 0 ? "" : ",") + fields[i];
+        return line;
+    };
+    std::string header_line = join(header);
+
+    // only start a new table if the file is new or its columns differ
+    std::string existing_header;
+    {
+        std::ifstream in(filename);
+        if (in) std::getline(in, existing_header);
+    }
+    std::ofstream out(filename, std::ios::app);
+    if (!out) crash("could not open result file " + filename);
+    if (existing_header != header_line) {
+        if (!existing_header.empty()) bmlog::warning("result file has different columns, starting a new header");
+        out << header_line << "\n";
+    }
+    out << join(row) << "\n";
+    if (!out) crash("could not write result file " + filename);
+}
+
+static std::string trim(const std::string& s) {
+    std::size_t start = s.find_first_not_of(" \t");
+    std::size_t end = s.find_last_not_of(" \t\n");
+    return start == std::string::npos ? "" : s.substr(start, end - start + 1);
+}
+
+static std::string cpu_model() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0 || line.rfind("Processor", 0) == 0) {
+            std::size_t colon = line.find(':');
+            if (colon != std::string::npos) return trim(line.substr(colon + 1));
+        }
+    }
+    return "unknown";
+}
+
+struct MountInfo {
+    std::string mount_point;
+    std::string device;
+    std::string fstype;
+    std::string options;
+};
+
+// the entry of /proc/self/mountinfo with the longest mount point that contains path
+static MountInfo mount_of(const std::string& path) {
+    MountInfo best{"", "unknown", "unknown", ""};
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string line;
+    while (std::getline(mountinfo, line)) {
+        // id parent major:minor root mount_point mount_options [optional...] - fstype source super_options
+        std::istringstream fields(line);
+        std::string id, parent, devno, root, mount_point, mount_options, field;
+        fields >> id >> parent >> devno >> root >> mount_point >> mount_options;
+        while (fields >> field && field != "-") {}
+        std::string fstype, source, super_options;
+        fields >> fstype >> source >> super_options;
+
+        bool contains = path == mount_point || mount_point == "/" || path.rfind(mount_point + "/", 0) == 0;
+        if (contains && mount_point.size() >= best.mount_point.size())
+            best = {mount_point, source, fstype, mount_options + "," + super_options};
+    }
+    return best;
+}
+
+static std::string dax_mode(const std::string& options) {
+    std::istringstream list(options);
+    std::string option;
+    std::string mode = "off";
+    while (std::getline(list, option, ',')) {
+        if (option == "dax" || option == "dax=always") mode = "always";
+        else if (option == "dax=inode") mode = "inode";
+        else if (option == "dax=never") mode = "never";
+    }
+    return mode;
+}
+
+void collect_machine_info(Report& report, const std::vector<std::string>& directories) {
+    char hostname[256] = "unknown";
+    gethostname(hostname, sizeof(hostname) - 1);
+    report.add("machine", "Hostname", hostname);
+    report.add("machine", "CPU Model", cpu_model());
+    report.add("machine", "Online CPUs", static_cast<long>(sysconf(_SC_NPROCESSORS_ONLN)));
+
+    struct utsname uts;
+    if (uname(&uts) == 0) {
+        report.add("machine", "Kernel", std::string(uts.sysname) + " " + uts.release);
+        report.add("machine", "Kernel Version", uts.version);
+        report.add("machine", "Architecture", uts.machine);
+    }
+
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    report.add("machine", "Timestamp", timestamp);
+
+    for (const std::string& dir : directories) {
+        char resolved[PATH_MAX];
+        std::string path = realpath(dir.c_str(), resolved) != nullptr ? std::string(resolved) : dir;
+        MountInfo mount = mount_of(path);
+        std::vector<ReportEntry> entries{
+            {"Directory", dir, true},
+            {"Mount Point", mount.mount_point, true},
+            {"Device", mount.device, true},
+            {"Filesystem", mount.fstype, true},
+            {"DAX", dax_mode(mount.options), true},
+        };
+#if defined(__linux) && defined(STATX_ATTR_DAX)
+        // with dax=inode only the file attribute tells the truth
+        struct statx stx;
+        if (statx(AT_FDCWD, path.c_str(), 0, STATX_BASIC_STATS, &stx) == 0 && (stx.stx_attributes_mask & STATX_ATTR_DAX))
+            entries.push_back({"Directory DAX Attribute", (stx.stx_attributes & STATX_ATTR_DAX) ? "1" : "0", false});
+#endif
+        report.add_mount(entries);
+    }
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+#include "histogram.hpp"
+#include "run_control.hpp"
+#include "util.hpp"
+
+// how often the monitor checks for finished workloads and the end of the run
+#define RUN_CONTROL_TICK_US 1000
+
+bool is_controlled(const struct RunControlConfig& config) {
+    return config.duration > 0 || config.warmup > 0 || config.steady_state;
+}
+
+RunControl::RunControl(const struct RunControlConfig& config) : config(config), start_ns(0), measure_start_ns(0), steady(true) {
+    if (config.steady_state && (config.window <= 0 || config.windows < 2))
+        crash("steady-state detection needs a window length and at least two windows");
+    phase.store(config.warmup > 0 || config.steady_state ? RUN_WARMUP : RUN_MEASURE, std::memory_order_release);
+}
+
+bool RunControl::stable() const {
+    if (samples.size() < config.windows) return false;
+    auto first = samples.end() - config.windows;
+    double mean = std::accumulate(first, samples.end(), 0.0) / config.windows;
+    if (mean <= 0) return false;
+    double squares = 0;
+    for (auto it = first; it != samples.end(); it++) squares += (*it - mean) * (*it - mean);
+    return std::sqrt(squares / (config.windows - 1)) / mean <= config.max_variation;
+}
+
+void RunControl::start_measurement(uint64_t now) {
+    measure_start_ns = now;
+    phase.store(RUN_MEASURE, std::memory_order_release);
+}
+
+void RunControl::monitor(const std::function<uint64_t()>& progress, const std::function<bool()>& finished) {
+    start_ns = now_ns();
+    if (phase.load(std::memory_order_relaxed) == RUN_MEASURE) measure_start_ns = start_ns;
+    uint64_t window_ns = static_cast<uint64_t>(config.window * 1e9);
+    uint64_t window_start = start_ns;
+    uint64_t window_progress = progress();
+    while (!finished()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(RUN_CONTROL_TICK_US));
+        uint64_t now = now_ns();
+        double elapsed = (now - start_ns) / 1e9;
+        RunPhase current = phase.load(std::memory_order_relaxed);
+
+        if (current == RUN_WARMUP && config.steady_state && now - window_start >= window_ns) {
+            uint64_t current_progress = progress();
+            samples.push_back((current_progress - window_progress) / ((now - window_start) / 1e9));
+            window_start = now;
+            window_progress = current_progress;
+        }
+        if (current == RUN_WARMUP && elapsed >= config.warmup) {
+            if (!config.steady_state || stable()) {
+                start_measurement(now);
+            } else if (elapsed >= config.max_warmup) {
+                bmlog::warning("the throughput did not become stable during the warm-up, measuring anyway");
+                steady = false;
+                start_measurement(now);
+            }
+        } else if (current == RUN_MEASURE && is_time_bounded() && (now - measure_start_ns) / 1e9 >= config.duration) {
+            phase.store(RUN_DONE, std::memory_order_release);
+        }
+    }
+    if (phase.load(std::memory_order_relaxed) == RUN_WARMUP) {
+        bmlog::warning("the workloads finished during the warm-up, nothing was measured");
+        steady = false;
+        start_measurement(now_ns());
+    }
+}
+
+uint64_t RunControl::get_measure_start_ns() const {
+    return measure_start_ns;
+}
+
+double RunControl::get_warmup_time() const {
+    return (measure_start_ns - start_ns) / 1e9;
+}
+
+bool RunControl::reached_steady_state() const {
+    return steady;
+}
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <string>
 #include <random>
+#include <sstream>
+#include <vector>
 #include <numeric>
 #include <functional>
 #include <utility>
@@ -73,11 +75,20 @@ uint32_t suffix_to_seed(std::string suffix) {
     return static_cast<uint32_t>(std::hash<std::string>()(suffix));
 }
 
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        if (!item.empty()) items.push_back(item);
+    return items;
+}
+
 AlignedMemoryBlock::AlignedMemoryBlock(uint32_t alignment, std::size_t len) {
     if (__builtin_popcount(alignment) != 1) crash("please only align zweierpotenzen");
     int align = alignment-1;
 
-    real_address = std::malloc(static_cast<int>(len+align));
+    real_address = std::malloc(len+align);
     if (real_address == NULL) crash("aligned memory allocation failed");
     aligned_address = (void*) (((uintptr_t)real_address+align)&~((uintptr_t)align));
 }
@@ -1,15 +1,22 @@
+#include <algorithm>
 #include <cstddef>
-#include <cstring>
+#include <memory>
 #include <random>
+#include <string>
 #include <vector>
+#include <unistd.h>
 
 #include "buffer_manager.hpp"
+#include "operation_stream.hpp"
 #include "workload.hpp"
 #include "util.hpp"
 
+// set in the tags of asynchronous writes, whose other bits are the pool page
+#define ASYNC_WRITE_TAG (static_cast<uint64_t>(1) << 63)
 
-BufferManagementWorkload::BufferManagementWorkload(BufferManager& bm, std::size_t total_workload, float write_proportion, int random_pages, uint32_t pattern_seed, uint64_t target_pages)
-    : bm(bm), total_workload(total_workload), write_proportion(write_proportion), pattern_seed(pattern_seed), target_pages(target_pages), max_page_id(bm.get_total_num_of_pages() - 1) {
+BufferManagementWorkload::BufferManagementWorkload(BufferManager& bm, std::size_t total_workload, float write_proportion, int random_pages, uint32_t pattern_seed, uint64_t target_pages, unsigned int queue_depth, PageDistribution *page_distribution)
+    : bm(bm), total_workload(total_workload), write_proportion(write_proportion), pattern_seed(pattern_seed), target_pages(target_pages), max_page_id(bm.get_total_num_of_pages() - 1), queue_depth(queue_depth),
+      page_distribution(page_distribution), generator(CustomSeededEngine(pattern_seed)), write_dis(0.0, 1.0), pagepool_dis(0, random_pages - 1), data_dis(0, 255) {
     for (int i = 0; i < random_pages; i++) {
         random_page_pool.emplace_back(bm.get_mem_alignment(), bm.get_page_size());
         for (unsigned int j = 0; j < bm.get_page_size(); j++) {
@@ -21,57 +28,229 @@ BufferManagementWorkload::BufferManagementWorkload(BufferManager& bm, std::size_
 }
 
 void BufferManagementWorkload::run() {
-    uint64_t processed_data = 0;
 
-    AlignedMemoryBlock buf(bm.get_mem_alignment(), target_pages * bm.get_page_size());
+    // every request in flight needs its own read target
+    uint64_t read_target_pages = std::max(target_pages, static_cast<uint64_t>(queue_depth));
+    AlignedMemoryBlock buf(bm.get_mem_alignment(), read_target_pages * bm.get_page_size());
     uint64_t read_target_page = 0;
-    while (processed_data < total_workload) {
-        uint64_t page_id = next_page_id();
 
-        if (do_write()) {
+    std::vector<struct iovec> memory{{*buf, read_target_pages * bm.get_page_size()}};
+    for (auto& page : random_page_pool) memory.push_back({*page, bm.get_page_size()});
+    bm.register_buffers(memory);
+
+    if (bm.has_pool()) {
+        run_pooled(static_cast<char*>(*buf), read_target_pages);
+        return;
+    }
+
+    if (queue_depth > 1) {
+        run_async(static_cast<char*>(*buf), read_target_pages);
+        return;
+    }
+
+    while (more(processed_data, total_workload)) {
+        begin_operation();
+        Operation op = next_operation();
+
+        if (op.is_write) {
             // write something
-            int random_poolpage_id = next_random_pagepool_id();
-            int random_position = next_random_position(bm.get_page_size()-1);
-            ((char*)(*(random_page_pool[random_poolpage_id])))[random_position] = static_cast<unsigned char>(next_random_data());
-            bm.pageout(*(random_page_pool[random_poolpage_id]), page_id);
+            ((char*)(*(random_page_pool[op.pool_page])))[op.offset] = static_cast<unsigned char>(op.value);
+            bm.pageout(*(random_page_pool[op.pool_page]), op.page_id);
         } else {
             // only a read
             char *tgt = (char*)*buf + bm.get_page_size() * read_target_page++;
             read_target_page %= target_pages;
-            if (bm.pagein(tgt, page_id) == BM_READ_FAILURE) {
+            if (bm.pagein(tgt, op.page_id) == BM_READ_FAILURE) {
                 bmlog::error("Paging in failed, aborting workload!");
                 return;
             }
         }
+        end_operation();
         processed_data += bm.get_page_size();
+        processed_operations++;
         //bmlog::info("processed data: " + std::to_string(processed_data));
     }
 }
 
+void BufferManagementWorkload::begin_measurement() {
+    bm.reset_statistics();
+}
+
+void BufferManagementWorkload::run_async(char *read_target, uint64_t read_target_pages) {
+    if (read_target_pages < queue_depth) crash("every request in flight needs its own read target page");
+    uint64_t submitted_data = 0;
+    std::size_t inflight = 0;
+    std::vector<BMCompletion> completions;
+    // completions arrive out of order, so a buffer is only reused once the completion of its last
+    // request has been reaped. Reads are tagged with their read target page, writes with their
+    // pool page and ASYNC_WRITE_TAG.
+    std::vector<uint64_t> free_targets;
+    for (uint64_t i = read_target_pages; i > 0; i--) free_targets.push_back(i - 1);
+    std::vector<bool> pool_page_busy(random_page_pool.size(), false);
+    // waits for at least one request, false if any of the completed ones failed
+    auto reap = [&](bool count) {
+        completions.clear();
+        bm.wait(completions);
+        inflight -= completions.size();
+        bool succeeded = true;
+        for (const BMCompletion& c : completions) {
+            if (!ok(c.status)) succeeded = false;
+            if (c.tag & ASYNC_WRITE_TAG)
+                pool_page_busy[c.tag & ~ASYNC_WRITE_TAG] = false;
+            else
+                free_targets.push_back(c.tag);
+        }
+        if (count) {
+            processed_data += completions.size() * bm.get_page_size();
+            processed_operations += completions.size();
+        }
+        return succeeded;
+    };
+    // requests still in flight when the run ends or is aborted would write into read_target after
+    // it is freed and complete in the next run, they are waited for but not counted
+    auto drain = [&]() {
+        while (inflight > 0) {
+            std::size_t before = inflight;
+            reap(false);
+            if (inflight == before) break;
+        }
+    };
+    while (more(processed_data, total_workload)) {
+        // keep the queue filled up
+        while (inflight < queue_depth && more(submitted_data, total_workload)) {
+            Operation op = next_operation();
+            BMStatus status;
+            if (op.is_write) {
+                // an earlier write of the same pool page may still be reading it
+                while (pool_page_busy[op.pool_page]) {
+                    if (!reap(true)) {
+                        bmlog::error("Asynchronous request failed, aborting workload!");
+                        drain();
+                        return;
+                    }
+                }
+                ((char*)(*(random_page_pool[op.pool_page])))[op.offset] = static_cast<unsigned char>(op.value);
+                pool_page_busy[op.pool_page] = true;
+                status = bm.submit_pageout(*(random_page_pool[op.pool_page]), op.page_id, op.pool_page | ASYNC_WRITE_TAG);
+            } else {
+                // fewer reads than queue_depth are in flight, so a read target page is free
+                uint64_t target_page = free_targets.back();
+                free_targets.pop_back();
+                status = bm.submit_pagein(read_target + bm.get_page_size() * target_page, op.page_id, target_page);
+            }
+            if (!ok(status)) {
+                bmlog::error("Submitting request failed, aborting workload!");
+                drain();
+                return;
+            }
+            inflight++;
+            submitted_data += bm.get_page_size();
+        }
+
+        if (!reap(true)) {
+            bmlog::error("Asynchronous request failed, aborting workload!");
+            drain();
+            return;
+        }
+    }
+    drain();
+}
+
+void BufferManagementWorkload::run_pooled(char *read_target, uint64_t read_target_pages) {
+    uint64_t read_target_page = 0;
+    while (more(processed_data, total_workload)) {
+        begin_operation();
+        Operation op = next_operation();
+        if (op.is_write) {
+            char *frame = static_cast<char*>(bm.pin(op.page_id));
+            if (frame == nullptr) {
+                bmlog::error("Pinning page failed, aborting workload!");
+                return;
+            }
+            // modify the page in place, it is written back once it gets evicted
+            frame[op.offset] = static_cast<unsigned char>(op.value);
+            bm.unpin(op.page_id, true);
+        } else {
+            char *tgt = read_target + bm.get_page_size() * read_target_page++;
+            read_target_page %= read_target_pages;
+            if (bm.read_page(op.page_id, tgt) != BM_READ_SUCCESS) {
+                bmlog::error("Reading page failed, aborting workload!");
+                return;
+            }
+        }
+        end_operation();
+        processed_data += bm.get_page_size();
+        processed_operations++;
+    }
+}
+
+void BufferManagementWorkload::pregenerate_operations(const std::string& stream_file) {
+    // a workload smaller than a page still needs an operation to repeat
+    uint64_t num_operations = std::max(total_workload / bm.get_page_size(), static_cast<std::size_t>(1));
+    struct OperationStreamHeader header{OPERATION_STREAM_MAGIC, num_operations, bm.get_total_num_of_pages(), bm.get_page_size(), random_page_pool.size(), {0, 0, 0}};
+
+    if (!stream_file.empty() && access(stream_file.c_str(), F_OK) == 0) {
+        operation_stream = std::make_unique<OperationStream>(stream_file);
+        const struct OperationStreamHeader& stored = operation_stream->get_header();
+        if (stored.num_pages > header.num_pages || stored.page_size != header.page_size || stored.random_pages != header.random_pages)
+            crash("operation stream " + stream_file + " was generated for a different buffer, page size or random page pool");
+        if (stored.num_operations == 0)
+            crash("operation stream " + stream_file + " has no operations");
+        if (stored.num_operations < header.num_operations)
+            bmlog::warning(("operation stream " + stream_file + " is shorter than the workload, it will be repeated").c_str());
+        bmlog::info("replaying " + std::to_string(stored.num_operations) + " operations from " + stream_file);
+        return;
+    }
+
+    if (random_page_pool.size() > UINT16_MAX + 1)
+        crash("operation streams support at most " + std::to_string(UINT16_MAX + 1) + " random pages");
+    operation_stream = std::make_unique<OperationStream>(header);
+    Operation *ops = operation_stream->data();
+    for (std::size_t i = 0; i < header.num_operations; i++) ops[i] = generate_operation();
+    if (!stream_file.empty()) {
+        operation_stream->save(stream_file);
+        bmlog::info("saved " + std::to_string(header.num_operations) + " operations to " + stream_file);
+    }
+}
+
+Operation BufferManagementWorkload::generate_operation() {
+    Operation op{0, 0, 0, 0, 0};
+    op.is_write = do_write();
+    op.page_id = next_page_id(op.is_write);
+    if (op.is_write) {
+        op.pool_page = static_cast<uint16_t>(next_random_pagepool_id());
+        op.offset = static_cast<uint32_t>(next_random_position(bm.get_page_size()-1));
+        op.value = static_cast<uint8_t>(next_random_data());
+    }
+    return op;
+}
+
+Operation BufferManagementWorkload::next_operation() {
+    if (!operation_stream) return generate_operation();
+    const Operation& op = (*operation_stream)[next_operation_index++];
+    if (next_operation_index == operation_stream->size()) next_operation_index = 0;
+    return op;
+}
+
 std::mt19937& BufferManagementWorkload::gen() {
-    static std::mt19937 generator = CustomSeededEngine(pattern_seed);
     return generator;
 }
 
 bool BufferManagementWorkload::do_write() {
-    static std::uniform_real_distribution<> dis(0.0, 1.0);
-    double val = dis(gen());
+    double val = write_dis(gen());
     return val < write_proportion;
 }
 
-uint64_t BufferManagementWorkload::next_page_id() {
-    static std::uniform_int_distribution<uint64_t> dis(0, max_page_id);
-    return dis(gen());
+uint64_t BufferManagementWorkload::next_page_id(bool write) {
+    return write ? page_distribution->next_write(gen()) : page_distribution->next(gen());
 }
 
 int BufferManagementWorkload::next_random_pagepool_id() {
-    static std::uniform_int_distribution<uint64_t> dis(0, random_page_pool.size() - 1);
-    return dis(gen());
+    return pagepool_dis(gen());
 }
 
 int BufferManagementWorkload::next_random_data() {
-    static std::uniform_int_distribution<int> dis(0, 255);
-    return dis(gen());
+    return data_dis(gen());
 }
 
 int BufferManagementWorkload::next_random_position(int maxval) {
@@ -7,26 +7,29 @@
 #include "buffer_manager.hpp"
 #include "util.hpp"
 
-LoggingWorkload::LoggingWorkload(BufferManager& bm, std::size_t total_workload, std::size_t log_entry_size, uint32_t pattern_seed, bool committing) :
-    bm(bm), total_workload(total_workload), log_entry_size(log_entry_size), pattern_seed(pattern_seed), committing(committing) {}
+LoggingWorkload::LoggingWorkload(BufferManager& bm, std::size_t total_workload, std::size_t log_entry_size, uint32_t pattern_seed, bool committing, uint64_t first_page_id, uint64_t last_page_id) :
+    bm(bm), total_workload(total_workload), log_entry_size(log_entry_size), pattern_seed(pattern_seed), committing(committing), first_page_id(first_page_id), last_page_id(last_page_id), generator(CustomSeededEngine(pattern_seed)) {}
 
 void LoggingWorkload::run() {
-    uint64_t processed_data = 0;
     bmlog::info("running logging.");
+    if (last_page_id <= first_page_id + (committing ? 1 : 0)) crash("the log of a thread needs a page for its entries besides the header");
     AlignedMemoryBlock buf(bm.get_mem_alignment(), bm.get_page_size());
     AlignedMemoryBlock logbuf(bm.get_mem_alignment(), log_entry_size);
     AlignedMemoryBlock headerbuf(bm.get_mem_alignment(), bm.get_page_size());
-    uint64_t current_page_id = committing ? 1 : 0;
+    bm.register_buffers({{*buf, bm.get_page_size()}, {*headerbuf, bm.get_page_size()}});
+    // the header page with the commit watermark comes first, then the log pages
+    uint64_t current_page_id = committing ? first_page_id + 1 : first_page_id;
+    uint64_t entries = 0;
     std::function<void()> update_watermark = [&](){
-        static uint64_t entries = 0;
-        *reinterpret_cast<uint64_t*>(*logbuf) = ++entries;
-        if (bm.pageout(*headerbuf, 0) == BM_WRITE_FAILURE) {
+        *reinterpret_cast<uint64_t*>(*headerbuf) = ++entries;
+        if (bm.pageout(*headerbuf, first_page_id) == BM_WRITE_FAILURE) {
             crash("Paging out (@commit) failed, aborting workload");
         }
     };
-    while (processed_data + log_entry_size <= total_workload) {
+    while (more(processed_data + log_entry_size - 1, total_workload)) {
+        begin_operation();
         // alter data
-        static_cast<char*>(*logbuf)[next_random_data(log_entry_size)] = next_random_data(255);
+        static_cast<char*>(*logbuf)[next_random_data(log_entry_size-1)] = next_random_data(255);
 
         // write log entry
         std::size_t to_write = log_entry_size;
@@ -39,6 +42,8 @@ void LoggingWorkload::run() {
                     bmlog::error("Paging out failed, aborting workload!");
                     return;
                 }
+                // time-bounded runs can log more than the slice holds, the log wraps around within it
+                if (current_page_id == last_page_id) current_page_id = committing ? first_page_id + 1 : first_page_id;
                 to_write -= bm.get_page_size() - pos_in_buf;
             } else { // write rest of log
                 std::memcpy(static_cast<char*>(*buf) + pos_in_buf, static_cast<char*>(*logbuf) + pos_in_logbuf, to_write);
@@ -50,13 +55,18 @@ void LoggingWorkload::run() {
             }
         }
         if (committing) update_watermark();
+        end_operation();
 
         processed_data += log_entry_size;
+        processed_operations++;
     }
 }
 
+void LoggingWorkload::begin_measurement() {
+    bm.reset_statistics();
+}
+
 std::mt19937& LoggingWorkload::gen() {
-    static std::mt19937 generator = CustomSeededEngine(pattern_seed);
     return generator;
 }
 
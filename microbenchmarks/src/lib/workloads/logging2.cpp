@@ -9,7 +9,7 @@
 
 
 SimpleLoggingWorkload::SimpleLoggingWorkload(std::string directory, std::string file_suffix, std::function<AppendableFile*(struct IOWrapperConfig&)> create_appendable_file, std::size_t total_workload, std::size_t log_entry_size, uint32_t pattern_seed, int page_pool_size, bool log_use_fallocate) :
-    total_workload(total_workload), log_entry_size(log_entry_size), pattern_seed(pattern_seed), page_pool_size(page_pool_size) {
+    total_workload(total_workload), log_entry_size(log_entry_size), pattern_seed(pattern_seed), page_pool_size(page_pool_size), generator(CustomSeededEngine(pattern_seed)) {
         for (int i = 0; i < page_pool_size; i++) {
             random_page_pool.emplace_back(1, log_entry_size);
             for (unsigned int j = 0; j < log_entry_size; j++) {
@@ -33,9 +33,9 @@ SimpleLoggingWorkload::~SimpleLoggingWorkload() {
 }
 
 void SimpleLoggingWorkload::run() {
-    uint64_t processed_data = 0;
     bmlog::info("running logging.");
-    while (processed_data + log_entry_size <= total_workload) {
+    while (more(processed_data + log_entry_size - 1, total_workload)) {
+        begin_operation();
         // select random page
         void *log_entry = *random_page_pool[next_random_data(page_pool_size-1)];
 
@@ -43,13 +43,26 @@ void SimpleLoggingWorkload::run() {
         static_cast<char*>(log_entry)[next_random_data(log_entry_size-1)] = next_random_data(255);
 
         // append to logfile
+        uint64_t start = track_latency ? now_ns() : 0;
         logfile->append(log_entry, log_entry_size);
+        if (track_latency) append_latency.record(now_ns() - start);
+        end_operation();
         processed_data += log_entry_size;
+        processed_operations++;
     }
 }
 
+std::vector<std::pair<std::string, const LatencyHistogram*>> SimpleLoggingWorkload::get_latencies() const {
+    auto latencies = Workload::get_latencies();
+    latencies.emplace_back("Append", &append_latency);
+    return latencies;
+}
+
+void SimpleLoggingWorkload::begin_measurement() {
+    append_latency = LatencyHistogram();
+}
+
 std::mt19937& SimpleLoggingWorkload::gen() {
-    static std::mt19937 generator = CustomSeededEngine(pattern_seed);
     return generator;
 }
 
@@ -1,24 +1,139 @@
 #include <cstddef>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "workload.hpp"
 #include "buffer_manager.hpp"
 
-TableScanWorkload::TableScanWorkload(BufferManager& bm, std::size_t total_workload) :
-    bm(bm), total_workload(total_workload) {}
+TableScanWorkload::TableScanWorkload(BufferManager& bm, std::size_t total_workload, unsigned int queue_depth, unsigned int batch_pages, uint64_t first_page_id) :
+    bm(bm), total_workload(total_workload), queue_depth(queue_depth), batch_pages(batch_pages), first_page_id(first_page_id) {}
 
 void TableScanWorkload::run() {
-    uint64_t processed_data = 0;
     bmlog::info("running tablescan.");
-    AlignedMemoryBlock buf(bm.get_mem_alignment(), bm.get_page_size());
-    uint64_t current_page_id = 0;
-    while (processed_data < total_workload) {
+    // one page per request in flight or page of a batch
+    std::size_t buf_pages = std::max(queue_depth, batch_pages);
+    AlignedMemoryBlock buf(bm.get_mem_alignment(), buf_pages * bm.get_page_size());
+    bm.register_buffers({{*buf, buf_pages * bm.get_page_size()}});
+    if (bm.has_pool()) {
+        run_pooled(static_cast<char*>(*buf));
+        return;
+    }
+    if (queue_depth > 1) {
+        run_async(static_cast<char*>(*buf));
+        return;
+    }
+    if (batch_pages > 1) {
+        run_batched(static_cast<char*>(*buf));
+        return;
+    }
+    uint64_t current_page_id = first_page_id % bm.get_total_num_of_pages();
+    while (more(processed_data, total_workload)) {
         if (bm.pagein(*buf, current_page_id) == BM_READ_FAILURE) {
             bmlog::error("Paging in failed, aborting workload!");
             return;
         }
         
         processed_data += bm.get_page_size();
+        processed_operations++;
+        current_page_id++;
+        current_page_id %= bm.get_total_num_of_pages();
+    }
+}
+
+void TableScanWorkload::begin_measurement() {
+    bm.reset_statistics();
+}
+
+void TableScanWorkload::run_async(char *read_target) {
+    uint64_t submitted_data = 0;
+    uint64_t current_page_id = first_page_id % bm.get_total_num_of_pages();
+    std::size_t inflight = 0;
+    std::vector<BMCompletion> completions;
+    // completions arrive out of order, so a read target page is only reused once the completion
+    // of its last request, which is tagged with it, has been reaped
+    std::vector<uint64_t> free_targets;
+    for (uint64_t i = queue_depth; i > 0; i--) free_targets.push_back(i - 1);
+    // waits for at least one request, false if any of the completed ones failed
+    auto reap = [&](bool count) {
+        completions.clear();
+        bm.wait(completions);
+        inflight -= completions.size();
+        bool succeeded = true;
+        for (const BMCompletion& c : completions) {
+            if (!ok(c.status)) succeeded = false;
+            free_targets.push_back(c.tag);
+        }
+        if (count) {
+            processed_data += completions.size() * bm.get_page_size();
+            processed_operations += completions.size();
+        }
+        return succeeded;
+    };
+    // requests still in flight when the run ends or is aborted would write into read_target after
+    // it is freed and complete in the next run, they are waited for but not counted
+    auto drain = [&]() {
+        while (inflight > 0) {
+            std::size_t before = inflight;
+            reap(false);
+            if (inflight == before) break;
+        }
+    };
+    while (more(processed_data, total_workload)) {
+        while (inflight < queue_depth && more(submitted_data, total_workload)) {
+            uint64_t target_page = free_targets.back();
+            free_targets.pop_back();
+            if (bm.submit_pagein(read_target + bm.get_page_size() * target_page, current_page_id, target_page) == BM_READ_FAILURE) {
+                bmlog::error("Submitting page in failed, aborting workload!");
+                drain();
+                return;
+            }
+            inflight++;
+            submitted_data += bm.get_page_size();
+            current_page_id++;
+            current_page_id %= bm.get_total_num_of_pages();
+        }
+
+        if (!reap(true)) {
+            bmlog::error("Paging in failed, aborting workload!");
+            drain();
+            return;
+        }
+    }
+    drain();
+}
+
+void TableScanWorkload::run_batched(char *read_target) {
+    uint64_t current_page_id = first_page_id % bm.get_total_num_of_pages();
+    std::vector<std::pair<uint64_t, void*>> batch;
+    while (more(processed_data, total_workload)) {
+        batch.clear();
+        for (unsigned int i = 0; i < batch_pages; i++) {
+            batch.emplace_back(current_page_id, read_target + i * bm.get_page_size());
+            current_page_id++;
+            current_page_id %= bm.get_total_num_of_pages();
+        }
+        if (bm.pagein_batch(batch) == BM_READ_FAILURE) {
+            bmlog::error("Paging in failed, aborting workload!");
+            return;
+        }
+
+        processed_data += batch_pages * bm.get_page_size();
+        processed_operations += batch_pages;
+    }
+}
+
+void TableScanWorkload::run_pooled(char *read_target) {
+    uint64_t current_page_id = first_page_id % bm.get_total_num_of_pages();
+    while (more(processed_data, total_workload)) {
+        if (bm.read_page(current_page_id, read_target) != BM_READ_SUCCESS) {
+            bmlog::error("Reading page failed, aborting workload!");
+            return;
+        }
+
+        processed_data += bm.get_page_size();
+        processed_operations++;
         current_page_id++;
         current_page_id %= bm.get_total_num_of_pages();
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,29 @@
+#include "workload.hpp"
+
+void Workload::set_run_control(RunControl *run_control) {
+    this->run_control = run_control;
+    phase = run_control ? run_control->get_phase() : RUN_MEASURE;
+}
+
+bool Workload::more(uint64_t data, std::size_t total_workload) {
+    if (!run_control) return data < total_workload;
+    progress.store(processed_data, std::memory_order_relaxed);
+    RunPhase current = run_control->get_phase();
+    if (phase == RUN_WARMUP && current != RUN_WARMUP) {
+        warmup_data = processed_data;
+        warmup_operations = processed_operations;
+        response_latency = LatencyHistogram();
+        service_latency = LatencyHistogram();
+        begin_measurement();
+    }
+    phase = current;
+    if (current == RUN_DONE) return false;
+    // the total workload only counts what is processed after the warm-up
+    if (current == RUN_WARMUP || run_control->is_time_bounded()) return true;
+    return data < warmup_data + total_workload;
+}
+
+std::vector<std::pair<std::string, const LatencyHistogram*>> Workload::get_latencies() const {
+    if (!arrivals) return {};
+    return {{"Response", &response_latency}, {"Service", &service_latency}};
+}
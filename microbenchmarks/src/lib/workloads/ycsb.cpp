@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer_manager.hpp"
+#include "distribution.hpp"
+#include "workload.hpp"
+#include "util.hpp"
+
+// updates of the same page by different threads are serialized on one of these, picked by page id
+#define YCSB_PAGE_LATCHES 1024
+static std::mutex page_latches[YCSB_PAGE_LATCHES];
+
+static const char *ycsb_operation_names[YCSB_NUM_OPERATIONS] = {"Read", "Update", "Insert", "Scan", "Read-Modify-Write"};
+
+struct YcsbMix ycsb_mix(char workload) {
+    //                           read   update insert scan   rmw
+    switch (workload) {
+        case 'A': return {{0.50, 0.50, 0.00, 0.00, 0.00}, false};
+        case 'B': return {{0.95, 0.05, 0.00, 0.00, 0.00}, false};
+        case 'C': return {{1.00, 0.00, 0.00, 0.00, 0.00}, false};
+        case 'D': return {{0.95, 0.00, 0.05, 0.00, 0.00}, true};
+        case 'E': return {{0.00, 0.00, 0.05, 0.95, 0.00}, false};
+        case 'F': return {{0.50, 0.00, 0.00, 0.00, 0.50}, false};
+        default: crash(std::string("unknown YCSB workload ") + workload);
+    }
+    return {{1.00, 0.00, 0.00, 0.00, 0.00}, false};
+}
+
+YcsbWorkload::YcsbWorkload(BufferManager& bm, std::size_t total_workload, struct YcsbMix mix, std::size_t record_size, uint64_t max_scan_length, uint32_t pattern_seed, const struct DistributionConfig& distribution_config, std::shared_ptr<std::atomic<uint64_t>> record_count)
+    : bm(bm), total_workload(total_workload), mix(mix), record_size(record_size), records_per_page(bm.get_page_size() / record_size),
+      record_capacity(records_per_page * bm.get_total_num_of_pages()), max_scan_length(max_scan_length), pattern_seed(pattern_seed),
+      record_count(record_count), generator(CustomSeededEngine(pattern_seed)), operation_dis(0.0, 1.0),
+      scan_length_dis(1, std::max(max_scan_length, static_cast<uint64_t>(1))), data_dis(0, 255),
+      buffer_pages((std::max(max_scan_length, static_cast<uint64_t>(1)) + records_per_page - 1) / std::max(records_per_page, static_cast<uint64_t>(1)) + 1),
+      page_buffer(bm.get_mem_alignment(), buffer_pages * bm.get_page_size()), record_buffer(record_size) {
+    if (records_per_page == 0) crash("YCSB records have to fit into a page");
+    uint64_t loaded_records = record_count->load();
+    if (loaded_records == 0 || loaded_records > record_capacity) crash("invalid number of loaded YCSB records " + std::to_string(loaded_records));
+    // like YCSB, the key space covers the records inserts will add and keys that do not exist yet are drawn again
+    if (mix.latest)
+        key_distribution.reset(create_page_distribution<ZipfianDistribution>(record_capacity, distribution_config));
+    else
+        key_distribution.reset(create_page_distribution<ScrambledZipfianDistribution>(record_capacity, distribution_config));
+}
+
+void YcsbWorkload::run() {
+    bm.register_buffers({{*page_buffer, buffer_pages * bm.get_page_size()}});
+
+    while (more(processed_data, total_workload)) {
+        begin_operation();
+        YcsbOperation operation = next_operation();
+        switch (operation) {
+            case YCSB_READ: read(next_record()); break;
+            case YCSB_UPDATE: update(next_record(), false); break;
+            case YCSB_INSERT: insert(); break;
+            case YCSB_SCAN: scan(next_record()); break;
+            case YCSB_RMW: update(next_record(), true); break;
+            default: break;
+        }
+        end_operation();
+        operation_counts[operation]++;
+        processed_operations++;
+    }
+}
+
+void YcsbWorkload::begin_measurement() {
+    bm.reset_statistics();
+    std::fill(std::begin(operation_counts), std::end(operation_counts), 0);
+}
+
+std::vector<std::pair<std::string, uint64_t>> YcsbWorkload::get_operation_counts() const {
+    std::vector<std::pair<std::string, uint64_t>> counts;
+    for (int i = 0; i < YCSB_NUM_OPERATIONS; i++) {
+        if (mix.proportions[i] > 0.0) counts.emplace_back(ycsb_operation_names[i], operation_counts[i]);
+    }
+    return counts;
+}
+
+YcsbOperation YcsbWorkload::next_operation() {
+    double val = operation_dis(generator);
+    for (int i = 0; i < YCSB_NUM_OPERATIONS; i++) {
+        if (val < mix.proportions[i]) return static_cast<YcsbOperation>(i);
+        val -= mix.proportions[i];
+    }
+    return YCSB_READ;
+}
+
+uint64_t YcsbWorkload::live_records() const {
+    return std::min(record_count->load(std::memory_order_relaxed), record_capacity);
+}
+
+uint64_t YcsbWorkload::next_record() {
+    uint64_t live = live_records();
+    uint64_t key;
+    do {
+        key = key_distribution->next(generator);
+    } while (key >= live);
+    if (!mix.latest) return key;
+    // key is the distance to the most recently inserted record, which wraps around with the inserts
+    uint64_t newest = (record_count->load(std::memory_order_relaxed) - 1) % record_capacity;
+    return (newest + record_capacity - key) % record_capacity;
+}
+
+char *YcsbWorkload::fetch_page(uint64_t page_id, char *buf) {
+    // like the other workloads, pages count as processed even if the buffer pool had them
+    processed_data += bm.get_page_size();
+    if (bm.has_pool()) {
+        char *frame = static_cast<char*>(bm.pin(page_id));
+        if (frame == nullptr) crash("could not pin page " + std::to_string(page_id));
+        return frame;
+    }
+    if (bm.pagein(buf, page_id) != BM_READ_SUCCESS) crash("could not read page " + std::to_string(page_id));
+    return buf;
+}
+
+void YcsbWorkload::release_page(uint64_t page_id, char *page, bool dirty) {
+    if (bm.has_pool()) {
+        bm.unpin(page_id, dirty);
+        return;
+    }
+    if (!dirty) return;
+    if (bm.pageout(page, page_id) != BM_WRITE_SUCCESS) crash("could not write page " + std::to_string(page_id));
+    processed_data += bm.get_page_size();
+}
+
+void YcsbWorkload::read(uint64_t record) {
+    uint64_t page_id = record / records_per_page;
+    char *page = fetch_page(page_id, static_cast<char*>(*page_buffer));
+    std::memcpy(record_buffer.data(), page + (record % records_per_page) * record_size, record_size);
+    release_page(page_id, page, false);
+}
+
+void YcsbWorkload::update(uint64_t record, bool read_first) {
+    uint64_t page_id = record / records_per_page;
+    // pins are shared and, without a pool, every thread writes back the whole page
+    std::lock_guard<std::mutex> guard(page_latches[page_id % YCSB_PAGE_LATCHES]);
+    char *page = fetch_page(page_id, static_cast<char*>(*page_buffer));
+    char *slot = page + (record % records_per_page) * record_size;
+    if (read_first) std::memcpy(record_buffer.data(), slot, record_size);
+    for (std::size_t i = 0; i < record_size; i++) slot[i] = static_cast<char>(data_dis(generator));
+    release_page(page_id, page, true);
+}
+
+void YcsbWorkload::insert() {
+    // once the buffer is full, inserts wrap around and overwrite the oldest records
+    uint64_t record = record_count->fetch_add(1, std::memory_order_relaxed) % record_capacity;
+    update(record, false);
+}
+
+void YcsbWorkload::scan(uint64_t first_record) {
+    uint64_t last_record = std::min(first_record + scan_length_dis(generator), live_records()) - 1;
+    char *target = static_cast<char*>(*page_buffer);
+    for (uint64_t page_id = first_record / records_per_page; page_id <= last_record / records_per_page; page_id++) {
+        char *page = fetch_page(page_id, target);
+        if (page != target) std::memcpy(target, page, bm.get_page_size());
+        release_page(page_id, page, false);
+        target += bm.get_page_size();
+    }
+}